@@ -0,0 +1,87 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#include <cmath>
+#include <unordered_set>
+
+#include "WL_Generator.h"
+#include "WL_Random.h"
+
+// Defaults: capacity 50% above demand, goods in [1, 40], fixed costs in [250, 750], uniform supply costs
+// in [1, 100] and as many incompatible pairs as stores
+GeneratorOptions::GeneratorOptions(unsigned warehouses, unsigned stores, unsigned seed)
+	: warehouses(warehouses), stores(stores), seed(seed), tightness(1.5), max_goods(40), fixed_cost(500), fixed_cost_spread(0.5),
+	  euclidean(false), max_supply_cost(100), incompatibility_density(stores > 1 ? 2.0 / (stores - 1) : 0)
+{
+}
+
+// Generates an instance (the same one for the same options); returns NULL if the options are invalid
+WL_Instance* GenerateInstance(const GeneratorOptions& options)
+{
+	unsigned W = options.warehouses, S = options.stores;
+	if (!W || !S || options.tightness <= 1 || options.fixed_cost_spread < 0 || options.fixed_cost_spread > 1
+		|| options.incompatibility_density < 0 || options.incompatibility_density > 0.5)
+		return NULL;
+	WL_Random rng(options.seed);
+
+	vector<unsigned> goods(S);
+	double total_goods = 0;
+	for (unsigned s = 0; s < S; s++)
+	{
+		goods[s] = 1 + rng.Below(options.max_goods);
+		total_goods += goods[s];
+	}
+
+	// Capacities share tightness * total goods in random proportions (in [0.5, 1.5] of the mean), and each
+	// warehouse can take the largest store
+	vector<double> shares(W);
+	double total_shares = 0;
+	for (unsigned w = 0; w < W; w++)
+		total_shares += shares[w] = 0.5 + rng.Uniform();
+	vector<unsigned> capacity(W), fixed_cost(W);
+	for (unsigned w = 0; w < W; w++)
+	{
+		capacity[w] = max(options.max_goods, (unsigned)ceil(options.tightness * total_goods * shares[w] / total_shares));
+		fixed_cost[w] = (unsigned)round(options.fixed_cost * (1 - options.fixed_cost_spread + 2 * options.fixed_cost_spread * rng.Uniform()));
+	}
+
+	vector<vector<double>> supply_cost(S, vector<double>(W));
+	if (options.euclidean)
+	{
+		// Stores and warehouses are random points in the unit square
+		vector<double> wx(W), wy(W);
+		for (unsigned w = 0; w < W; w++)
+		{
+			wx[w] = rng.Uniform();
+			wy[w] = rng.Uniform();
+		}
+		for (unsigned s = 0; s < S; s++)
+		{
+			double x = rng.Uniform(), y = rng.Uniform();
+			for (unsigned w = 0; w < W; w++)
+				supply_cost[s][w] = max(1.0, round(options.max_supply_cost * hypot(x - wx[w], y - wy[w]) / sqrt(2.0)));
+		}
+	}
+	else
+		for (unsigned s = 0; s < S; s++)
+			for (unsigned w = 0; w < W; w++)
+				supply_cost[s][w] = 1 + rng.Below(options.max_supply_cost);
+
+	// Distinct random store pairs (the density is at most 0.5, so rejection sampling terminates quickly)
+	unsigned long long pairs = (unsigned long long)S * (S - 1) / 2;
+	unsigned incompatibilities = (unsigned)round(options.incompatibility_density * pairs);
+	vector<pair<unsigned, unsigned>> store_incompatibilities;
+	unordered_set<unsigned long long> chosen;
+	while (store_incompatibilities.size() < incompatibilities)
+	{
+		unsigned s1 = rng.Below(S), s2 = rng.Below(S);
+		if (s1 == s2)
+			continue;
+		if (s1 > s2)
+			swap(s1, s2);
+		if (chosen.insert((unsigned long long)s1 * S + s2).second)
+			store_incompatibilities.push_back(make_pair(s1, s2));
+	}
+
+	return WL_Instance::Create(capacity, fixed_cost, goods, supply_cost, store_incompatibilities);
+}
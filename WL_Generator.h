@@ -0,0 +1,26 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#ifndef _WL_GENERATOR
+#define _WL_GENERATOR
+
+#include "WL_Instance.h"
+
+// Parameters of synthetic instances
+struct GeneratorOptions
+{
+	unsigned warehouses, stores, seed;
+	double tightness;                 // total capacity / total amount of goods (> 1)
+	unsigned max_goods;               // goods of each store in [1, max_goods]
+	unsigned fixed_cost;              // mean fixed cost
+	double fixed_cost_spread;         // fixed costs in fixed_cost * [1 - spread, 1 + spread]
+	bool euclidean;                   // supply costs proportional to distances between random points, else uniform
+	unsigned max_supply_cost;         // supply costs in [1, max_supply_cost]
+	double incompatibility_density;   // fraction of the store pairs that are incompatible
+
+	GeneratorOptions(unsigned warehouses, unsigned stores, unsigned seed);
+};
+
+WL_Instance* GenerateInstance(const GeneratorOptions& options);
+
+#endif
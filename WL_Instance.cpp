@@ -2,6 +2,7 @@
 
 
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 
 #include "WL_Instance.h"
@@ -10,19 +11,48 @@
 WL_Instance::WL_Instance(string file_name)
 		: reduction_opening_cost(0), reduction_supply_cost(0)
 {	
-	const unsigned MAX_DIM = 100;
-	unsigned w, s, s2;
-	char ch, buffer[MAX_DIM];
-
 	ifstream is(file_name);
 	if(!is)
 	{
 		cerr << "Cannot open input file " <<	file_name << endl;
 		exit(1);
 	}
-	
-	is >> buffer >> ch >> warehouses >> ch;
-	is >> buffer >> ch >> stores >> ch;
+	if (!Read(is))
+	{
+		cerr << "Invalid input file " << file_name << endl;
+		exit(1);
+	}
+	is.close();
+}
+
+// Reads instance in .dzn format from a stream (e.g. a socket); returns NULL if the data is malformed
+WL_Instance* WL_Instance::Parse(istream& is)
+{
+	WL_Instance* in = new WL_Instance();
+	if (!in->Read(is))
+	{
+		delete in;
+		return NULL;
+	}
+	return in;
+}
+
+WL_Instance::WL_Instance()
+		: stores(0), warehouses(0), reduction_opening_cost(0), reduction_supply_cost(0)
+{
+}
+
+// Reads the data in .dzn format; returns false if it is malformed
+bool WL_Instance::Read(istream& is)
+{
+	const unsigned MAX_DIM = 100;
+	unsigned w, s, s2;
+	char ch, buffer[MAX_DIM];
+
+	is >> setw(MAX_DIM) >> buffer >> ch >> warehouses >> ch;
+	is >> setw(MAX_DIM) >> buffer >> ch >> stores >> ch;
+	if (!is || !warehouses || !stores)
+		return false;
 	
 	capacity.resize(warehouses);
 	fixed_cost.resize(warehouses);
@@ -55,15 +85,21 @@ WL_Instance::WL_Instance(string file_name)
 			is >> supply_cost[s][w] >> ch;
 	}
 	is >> ch >> ch;
+	if (!is)
+		return false;
 
 	// read store incompatibilities
 	unsigned incompatibilities;
-	is >> buffer >> ch >> incompatibilities >> ch;	
+	is >> setw(MAX_DIM) >> buffer >> ch >> incompatibilities >> ch;	
+	if (!is || incompatibilities > stores * stores)
+		return false;
 	store_incompatibilities.resize(incompatibilities);
 	is.ignore(MAX_DIM,'['); // read "... IncompatiblePairs = ["
 	for (unsigned i = 0; i < incompatibilities; i++)
 	{
 		is >> ch >> s >> ch >> s2; 
+		if (!is || s < 1 || s > stores || s2 < 1 || s2 > stores)
+			return false;
 		store_incompatibilities[i].first = s - 1;
 		store_incompatibilities[i].second = s2 - 1;
 		incompatible[s - 1][s2 - 1] = true;
@@ -71,7 +107,38 @@ WL_Instance::WL_Instance(string file_name)
 	}
 	is >> ch >> ch;
 	
-	is.close();
+	return true;
+}
+
+// Builds an instance in memory (0-based indices; `supply_cost[s][w]` is the cost of supplying a unit of
+// store s from warehouse w); returns NULL if the dimensions are inconsistent or an incompatibility is invalid
+WL_Instance* WL_Instance::Create(const vector<unsigned>& capacity, const vector<unsigned>& fixed_cost, const vector<unsigned>& amount_of_goods,
+								 const vector<vector<double>>& supply_cost, const vector<pair<unsigned, unsigned>>& store_incompatibilities)
+{
+	unsigned stores = amount_of_goods.size(), warehouses = capacity.size();
+	if (!stores || !warehouses || fixed_cost.size() != warehouses || supply_cost.size() != stores)
+		return NULL;
+	for (unsigned s = 0; s < stores; s++)
+		if (supply_cost[s].size() != warehouses)
+			return NULL;
+	for (unsigned i = 0; i < store_incompatibilities.size(); i++)
+		if (store_incompatibilities[i].first >= stores || store_incompatibilities[i].second >= stores)
+			return NULL;
+	return new WL_Instance(capacity, fixed_cost, amount_of_goods, supply_cost, store_incompatibilities);
+}
+
+WL_Instance::WL_Instance(const vector<unsigned>& capacity, const vector<unsigned>& fixed_cost, const vector<unsigned>& amount_of_goods,
+						 const vector<vector<double>>& supply_cost, const vector<pair<unsigned, unsigned>>& store_incompatibilities)
+		: stores(amount_of_goods.size()), warehouses(capacity.size()), reduction_opening_cost(0), reduction_supply_cost(0), capacity(capacity),
+		fixed_cost(fixed_cost), amount_of_goods(amount_of_goods), supply_cost(supply_cost), store_incompatibilities(store_incompatibilities)
+{
+	incompatible.resize(stores, vector<bool>(stores, false));
+	w_incompatible.resize(warehouses, vector<bool>(stores, false));
+	for (unsigned i = 0; i < store_incompatibilities.size(); i++)
+	{
+		incompatible[store_incompatibilities[i].first][store_incompatibilities[i].second] = true;
+		incompatible[store_incompatibilities[i].second][store_incompatibilities[i].first] = true;
+	}
 }
 
 // Creates a reduced version of instance `in` based on the provided pattern
@@ -90,4 +157,79 @@ WL_Instance::WL_Instance(const WL_Instance& in, vector<Supply> pattern)
 			if (incompatible[pattern[i].s][s])
 				w_incompatible[pattern[i].w][s] = true;
 	}
-}
\ No newline at end of file
+}
+
+// Applies changes to capacities, costs, goods and store incompatibilities
+void WL_Instance::ApplyDelta(const InstanceDelta& delta)
+{
+	for (unsigned i = 0; i < delta.capacities.size(); i++)
+		capacity[delta.capacities[i].first] = delta.capacities[i].second;
+	for (unsigned i = 0; i < delta.fixed_costs.size(); i++)
+		fixed_cost[delta.fixed_costs[i].first] = delta.fixed_costs[i].second;
+	for (unsigned i = 0; i < delta.goods.size(); i++)
+		amount_of_goods[delta.goods[i].first] = delta.goods[i].second;
+	for (unsigned i = 0; i < delta.supply_costs.size(); i++)
+		supply_cost[delta.supply_costs[i].s][delta.supply_costs[i].w] = delta.supply_costs[i].cost;
+
+	for (unsigned i = 0; i < delta.removed_incompatibilities.size(); i++)
+	{
+		unsigned s = delta.removed_incompatibilities[i].first, s2 = delta.removed_incompatibilities[i].second;
+		incompatible[s][s2] = false;
+		incompatible[s2][s] = false;
+		for (unsigned j = 0; j < store_incompatibilities.size(); j++)
+			if ((store_incompatibilities[j].first == s && store_incompatibilities[j].second == s2) 
+					|| (store_incompatibilities[j].first == s2 && store_incompatibilities[j].second == s))
+			{
+				store_incompatibilities.erase(store_incompatibilities.begin() + j);
+				break;
+			}
+	}
+
+	for (unsigned i = 0; i < delta.added_incompatibilities.size(); i++)
+	{
+		unsigned s = delta.added_incompatibilities[i].first, s2 = delta.added_incompatibilities[i].second;
+		if (!incompatible[s][s2])
+		{
+			store_incompatibilities.push_back(make_pair(s, s2));
+			incompatible[s][s2] = true;
+			incompatible[s2][s] = true;
+		}
+	}
+}
+
+// Writes the instance in .dzn format (as read by the constructor)
+void WL_Instance::Write(ostream& os) const
+{
+	os << "Warehouses = " << warehouses << ";" << endl;
+	os << "Stores = " << stores << ";" << endl << endl;
+
+	os << "Capacity = [";
+	for (unsigned w = 0; w < warehouses; w++)
+		os << (w ? ", " : "") << capacity[w];
+	os << "];" << endl;
+
+	os << "FixedCost = [";
+	for (unsigned w = 0; w < warehouses; w++)
+		os << (w ? ", " : "") << fixed_cost[w];
+	os << "];" << endl;
+
+	os << "Goods = [";
+	for (unsigned s = 0; s < stores; s++)
+		os << (s ? ", " : "") << amount_of_goods[s];
+	os << "];" << endl;
+
+	os << "SupplyCost = [";
+	for (unsigned s = 0; s < stores; s++)
+	{
+		os << (s ? "\n|" : "|");
+		for (unsigned w = 0; w < warehouses; w++)
+			os << (w ? ", " : "") << supply_cost[s][w];
+	}
+	os << "|];" << endl << endl;
+
+	os << "Incompatibilities = " << store_incompatibilities.size() << ";" << endl;
+	os << "IncompatiblePairs = [";
+	for (unsigned i = 0; i < store_incompatibilities.size(); i++)
+		os << (i ? "\n| " : "| ") << store_incompatibilities[i].first + 1 << ", " << store_incompatibilities[i].second + 1;
+	os << (store_incompatibilities.empty() ? "];" : " |];") << endl;
+}
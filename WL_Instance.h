@@ -4,6 +4,8 @@
 #ifndef _WL_INSTANCE
 #define _WL_INSTANCE
 
+#include <istream>
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -15,12 +17,33 @@ struct Supply
     unsigned w, s, q;
 };
 
+// Changes to the data of an instance (0-based indices), e.g. between daily runs
+struct InstanceDelta
+{
+	struct SupplyCostChange
+	{
+		unsigned s, w;
+		double cost;
+	};
+
+	vector<pair<unsigned, unsigned>> capacities;  // (w, new capacity)
+	vector<pair<unsigned, unsigned>> fixed_costs; // (w, new fixed cost)
+	vector<pair<unsigned, unsigned>> goods;       // (s, new amount of goods)
+	vector<SupplyCostChange> supply_costs;
+	vector<pair<unsigned, unsigned>> added_incompatibilities, removed_incompatibilities; // store pairs
+};
+
 // Problem input instance
 class WL_Instance 
 {
 public:
 	WL_Instance(string file_name);
 	WL_Instance(const WL_Instance& in, vector<Supply> pattern);
+	static WL_Instance* Parse(istream& is);
+	static WL_Instance* Create(const vector<unsigned>& capacity, const vector<unsigned>& fixed_cost, const vector<unsigned>& amount_of_goods,
+							   const vector<vector<double>>& supply_cost, const vector<pair<unsigned, unsigned>>& store_incompatibilities);
+	void ApplyDelta(const InstanceDelta& delta); // only for original (not reduced) instances
+	void Write(ostream& os) const; // .dzn format
 	unsigned Stores() const { return stores; }
 	unsigned Warehouses() const { return warehouses; }
 	unsigned ReductionOpeningCost() const { return reduction_opening_cost; }
@@ -43,6 +66,10 @@ public:
 	vector<pair<unsigned, unsigned>> store_incompatibilities;
 	vector<vector<bool>> incompatible; //	store/store incompatibility matrix
 	vector<vector<bool>> w_incompatible; //	warehouse/store incompatibility matrix
+	WL_Instance();
+	WL_Instance(const vector<unsigned>& capacity, const vector<unsigned>& fixed_cost, const vector<unsigned>& amount_of_goods,
+				const vector<vector<double>>& supply_cost, const vector<pair<unsigned, unsigned>>& store_incompatibilities);
+	bool Read(istream& is);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,178 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#include <cerrno>
+#include <iostream>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "WL_Island.h"
+#include "WL_Log.h"
+
+// Header of a slot of the shared segment, followed by the sizes of the patterns and by the supplies of the
+// solution and of the patterns
+struct IslandSlot
+{
+	pthread_mutex_t mutex; // process-shared and robust (see LockSlot)
+	unsigned version;      // number of emigrations so far
+	double cost, time;
+	unsigned solution_size, patterns;
+	unsigned* PatternSizes() { return (unsigned*)(this + 1); }
+};
+
+// Creates the shared segment (must be called by the coordinator, before forking the islands)
+WL_Island::WL_Island(unsigned islands, const WL_Instance& in)
+	: islands(islands), id(0), max_supplies(2 * (in.Stores() + in.Warehouses())), max_patterns(64), last_version(0)
+{
+	slot_size = sizeof(IslandSlot) + max_patterns * sizeof(unsigned) + 2 * max_supplies * sizeof(Supply);
+	slot_size = (slot_size + 63) / 64 * 64;
+
+	segment = (char*)mmap(NULL, islands * slot_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (segment == MAP_FAILED)
+	{
+		cerr << "Cannot create shared memory segment for " << islands << " islands" << endl;
+		exit(1);
+	}
+
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+	pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+	for (unsigned i = 0; i < islands; i++)
+	{
+		IslandSlot* slot = GetSlot(i);
+		pthread_mutex_init(&slot->mutex, &attr);
+		slot->version = 0;
+		slot->solution_size = slot->patterns = 0;
+	}
+	pthread_mutexattr_destroy(&attr);
+}
+
+WL_Island::~WL_Island()
+{
+	munmap(segment, islands * slot_size);
+}
+
+IslandSlot* WL_Island::GetSlot(unsigned i) const
+{
+	return (IslandSlot*)(segment + i * slot_size);
+}
+
+// Locks the mutex of `slot`; if an island died holding it, the slot may be half written, so it is emptied
+// (a new version with no solution and no patterns) before the mutex is made consistent again
+static void LockSlot(IslandSlot* slot)
+{
+	if (pthread_mutex_lock(&slot->mutex) == EOWNERDEAD)
+	{
+		WL_WARN("island slot abandoned by a dead island: emptied");
+		slot->solution_size = slot->patterns = 0;
+		slot->version++;
+		pthread_mutex_consistent(&slot->mutex);
+	}
+}
+
+// Publishes solution `sol` (found at `time`) and `patterns` in the slot of this island
+// Patterns that do not fit the slot are left out; a solution that does not fit is skipped, and the one
+// published before stays in the slot
+void WL_Island::Emigrate(const WL_Solution& sol, double time, const vector<vector<Supply>>& patterns)
+{
+	IslandSlot* slot = GetSlot(id);
+	Supply* supplies = (Supply*)(slot->PatternSizes() + max_patterns);
+
+	unsigned size = 0;
+	for (unsigned w = 0; w < sol.supplied_stores.size(); w++)
+		size += sol.supplied_stores[w].size();
+
+	LockSlot(slot);
+
+	if (size <= max_supplies)
+	{
+		unsigned n = 0;
+		for (unsigned w = 0; w < sol.supplied_stores.size(); w++)
+			for (auto it = sol.supplied_stores[w].begin(); it != sol.supplied_stores[w].end(); ++it)
+				supplies[n++] = {w, *it, sol.Supply(*it, w)};
+		slot->solution_size = n;
+		slot->cost = sol.Cost();
+		slot->time = time;
+	}
+	else
+		WL_WARN("island %u: solution with %u supplies not published (at most %u)", id, size, max_supplies);
+	unsigned n = slot->solution_size;
+
+	slot->patterns = 0;
+	for (unsigned i = 0; i < patterns.size() && slot->patterns < max_patterns && n + patterns[i].size() <= 2 * max_supplies; i++)
+	{
+		for (unsigned j = 0; j < patterns[i].size(); j++)
+			supplies[n++] = patterns[i][j];
+		slot->PatternSizes()[slot->patterns++] = patterns[i].size();
+	}
+
+	slot->version++;
+
+	pthread_mutex_unlock(&slot->mutex);
+}
+
+// Receives the solution and patterns published by the previous island in the ring, if they changed since
+// the last migration (the migrant solution is created on instance `in`, and is NULL if none was published)
+// Returns false if there is nothing new
+bool WL_Island::Immigrate(WL_Instance& in, WL_Solution** migrant, vector<vector<Supply>>* patterns)
+{
+	IslandSlot* slot = GetSlot((id + islands - 1) % islands);
+	Supply* supplies = (Supply*)(slot->PatternSizes() + max_patterns);
+	bool received = false;
+
+	*migrant = NULL;
+
+	LockSlot(slot);
+
+	if (slot->version != last_version)
+	{
+		last_version = slot->version;
+		received = true;
+
+		if (slot->solution_size)
+		{
+			*migrant = new WL_Solution(in);
+			for (unsigned i = 0; i < slot->solution_size; i++)
+				(*migrant)->Assign(supplies[i].s, supplies[i].w, supplies[i].q);
+		}
+
+		unsigned n = slot->solution_size;
+		for (unsigned i = 0; i < slot->patterns; i++)
+		{
+			patterns->push_back(vector<Supply>(supplies + n, supplies + n + slot->PatternSizes()[i]));
+			n += slot->PatternSizes()[i];
+		}
+	}
+
+	pthread_mutex_unlock(&slot->mutex);
+
+	return received;
+}
+
+// Returns the best solution published by the islands (created on instance `in`, NULL if none was published),
+// setting `time` to the time it was found
+WL_Solution* WL_Island::Best(WL_Instance& in, double* time) const
+{
+	WL_Solution* best = NULL;
+
+	for (unsigned i = 0; i < islands; i++)
+	{
+		IslandSlot* slot = GetSlot(i);
+		Supply* supplies = (Supply*)(slot->PatternSizes() + max_patterns);
+
+		LockSlot(slot);
+		if (slot->solution_size && (best == NULL || slot->cost < best->Cost()))
+		{
+			if (best != NULL)
+				delete best;
+			best = new WL_Solution(in);
+			for (unsigned j = 0; j < slot->solution_size; j++)
+				best->Assign(supplies[j].s, supplies[j].w, supplies[j].q);
+			*time = slot->time;
+		}
+		pthread_mutex_unlock(&slot->mutex);
+	}
+
+	return best;
+}
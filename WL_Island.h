@@ -0,0 +1,35 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#ifndef _WL_ISLAND
+#define _WL_ISLAND
+
+#include <vector>
+
+#include "WL_Instance.h"
+#include "WL_Solution.h"
+
+// Island model exchange for solver processes on the same machine
+// The coordinator creates an anonymous shared-memory segment before forking the islands; each island owns a slot
+// where it publishes (emigrates) its best solution and its mined patterns, in sparse form
+// Migration policy: unidirectional ring - island i receives (immigrates) from island i-1, whenever that
+// island has published something new since the last migration
+class WL_Island
+{
+public:
+	WL_Island(unsigned islands, const WL_Instance& in);
+	~WL_Island();
+	void Join(unsigned id) { this->id = id; } // called by each island process after the fork
+	unsigned Id() const { return id; }
+	unsigned Islands() const { return islands; }
+	void Emigrate(const WL_Solution& sol, double time, const vector<vector<Supply>>& patterns);
+	bool Immigrate(WL_Instance& in, WL_Solution** migrant, vector<vector<Supply>>* patterns);
+	WL_Solution* Best(WL_Instance& in, double* time) const; // best solution published by any island
+private:
+	unsigned islands, id, max_supplies, max_patterns, last_version;
+	size_t slot_size;
+	char* segment;
+	struct IslandSlot* GetSlot(unsigned i) const;
+};
+
+#endif
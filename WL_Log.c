@@ -0,0 +1,75 @@
+/* Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br> */
+
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "WL_Log.h"
+
+#define WL_LOG_BUFFER_SIZE 65536
+#define WL_LOG_LINE_SIZE 1024
+
+int wl_log_level = WL_LOG_WARN;
+
+static const char *wl_log_names[] = {"error", "warning", "info", "debug"};
+static char wl_log_buffer[WL_LOG_BUFFER_SIZE];
+static size_t wl_log_used = 0;
+static int wl_log_at_exit = 0;
+static pthread_mutex_t wl_log_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void wl_log_flush_locked(void)
+{
+	if (wl_log_used)
+	{
+		fwrite(wl_log_buffer, 1, wl_log_used, stderr);
+		fflush(stderr);
+		wl_log_used = 0;
+	}
+}
+
+void wl_log_flush(void)
+{
+	pthread_mutex_lock(&wl_log_mutex);
+	wl_log_flush_locked();
+	pthread_mutex_unlock(&wl_log_mutex);
+}
+
+int wl_log_parse_level(const char *name)
+{
+	int level;
+	for (level = WL_LOG_ERROR; level <= WL_LOG_DEBUG; level++)
+		if (!strcmp(name, wl_log_names[level]) || (name[0] == '0' + level && !name[1]))
+			return level;
+	return -1;
+}
+
+/* Formats the message as one line "[level] message" and appends it to the buffer */
+void wl_log_write(int level, const char *format, ...)
+{
+	char line[WL_LOG_LINE_SIZE];
+	int n = snprintf(line, sizeof(line), "[%s] ", wl_log_names[level]);
+	va_list args;
+	va_start(args, format);
+	n += vsnprintf(line + n, sizeof(line) - n, format, args);
+	va_end(args);
+	if (n > WL_LOG_LINE_SIZE - 2)
+		n = WL_LOG_LINE_SIZE - 2; /* truncated */
+	line[n++] = '\n';
+
+	pthread_mutex_lock(&wl_log_mutex);
+	if (!wl_log_at_exit)
+	{
+		atexit(wl_log_flush);
+		wl_log_at_exit = 1;
+	}
+	if (wl_log_used + n > WL_LOG_BUFFER_SIZE)
+		wl_log_flush_locked();
+	memcpy(wl_log_buffer + wl_log_used, line, n);
+	wl_log_used += n;
+	if (level <= WL_LOG_WARN)
+		wl_log_flush_locked();
+	pthread_mutex_unlock(&wl_log_mutex);
+}
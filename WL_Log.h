@@ -0,0 +1,43 @@
+/* Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br> */
+
+
+#ifndef _WL_LOG
+#define _WL_LOG
+
+/* Leveled logger shared by the C++ solver and the C code, writing printf-style messages to stderr
+   Messages are buffered (flushed when the buffer fills, on warnings and errors, and at exit); the runtime
+   level `wl_log_level` is quiet (warnings and errors) by default, and messages above the compile-time level
+   WL_LOG_LEVEL compile down to nothing, arguments included. WL_LOG_LEVEL defaults to WL_LOG_INFO, so that the
+   debug messages of the hot paths cost nothing in a normal build; build with -DWL_LOG_LEVEL=WL_LOG_DEBUG to
+   get them */
+
+#define WL_LOG_ERROR 0
+#define WL_LOG_WARN 1
+#define WL_LOG_INFO 2
+#define WL_LOG_DEBUG 3
+
+#ifndef WL_LOG_LEVEL
+#define WL_LOG_LEVEL WL_LOG_INFO
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int wl_log_level;
+int wl_log_parse_level(const char *name); /* level from its name or number; -1 if invalid */
+void wl_log_write(int level, const char *format, ...) __attribute__((format(printf, 2, 3)));
+void wl_log_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define WL_LOG(level, ...) \
+	do { if ((level) <= WL_LOG_LEVEL && (level) <= wl_log_level) wl_log_write((level), __VA_ARGS__); } while (0)
+#define WL_ERROR(...) WL_LOG(WL_LOG_ERROR, __VA_ARGS__)
+#define WL_WARN(...) WL_LOG(WL_LOG_WARN, __VA_ARGS__)
+#define WL_INFO(...) WL_LOG(WL_LOG_INFO, __VA_ARGS__)
+#define WL_DEBUG(...) WL_LOG(WL_LOG_DEBUG, __VA_ARGS__)
+
+#endif
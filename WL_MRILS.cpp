@@ -2,11 +2,17 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <queue>
 #include "fpmax.h"
 
+#include "WL_Log.h"
 #include "WL_MRILS.h"
+#include "WL_Miner.h"
+#include "WL_Roulette.h"
 
 extern "C"
 {
@@ -28,139 +34,614 @@ struct WarehouseComparator
 };
 
 // Comparator for ordering solutions by cost
-bool CompareSolutions(WL_Solution sol1, WL_Solution sol2)
+bool CompareSolutions(const WL_Solution &sol1, const WL_Solution &sol2)
 {
 	return sol1.Cost() < sol2.Cost() - MY_EPSILON;
 }
 
-// Move structure
-// If store `s2` is out of range, then type I: supply to store `s1` by warehouse `w1` is reassigned to warehouse `w2`
-// 			(the quantity reassigned is the max between the quantity assigned to `w1` and the residual capacity of `w2`)
-// Otherwise, type II: supply to store `s1` by warehouse `w1` is swaped with supply to store `s2` by warehouse `w2` - i.e. {(w1, s1, q1), (w2, s2, q2)} -> {(w1, s2, q2), (w2, s1, q1)}
-struct Move
+WL_MRILS::WL_MRILS(WL_Instance &my_in, double timeout, unsigned seed, unsigned elite_max_size, double stabi_param,
+				   double min_sup, unsigned n_patterns, bool random_opening, unsigned ils_maxiter, double ils_accept, unsigned threads)
+	: in(my_in), best(NULL), time_best(0), timeout(timeout), evaluations_done(0), ils_iterations_done(0), seed(seed), elite_max_size(elite_max_size), n_patterns(n_patterns),
+	  ils_maxiter(ils_maxiter), min_sup(min_sup), ils_accept(ils_accept), stabi_param(stabi_param), random_opening(random_opening),
+	  elite(CompareSolutions), pattern_schedule(SCHEDULE_ROUND_ROBIN), rng(seed, 0), shared(this), worker_id(0), threads(threads), island(NULL), migration_interval(0),
+	  parallel_patterns(false), support_quantities(false), checkpoint_interval(0), resumed(false), trace(NULL), trace_ils(false), current_iteration(0),
+	  current_pattern(-1)
 {
-	unsigned s1, s2, w1, w2;
-	double improvement;
-};
+}
+
+// Creates worker `worker` that searches on its own instance `my_in` and shares the elite pool, the patterns
+// and the best solution of `my_shared` (the random number stream of the worker is kept by `my_shared`, see Run)
+WL_MRILS::WL_MRILS(WL_MRILS &my_shared, WL_Instance &my_in, unsigned worker)
+	: in(my_in), best(NULL), time_best(0), timeout(my_shared.timeout), evaluations_done(0), ils_iterations_done(0), seed(my_shared.seed), elite_max_size(my_shared.elite_max_size),
+	  n_patterns(my_shared.n_patterns), ils_maxiter(my_shared.ils_maxiter), min_sup(my_shared.min_sup), ils_accept(my_shared.ils_accept),
+	  stabi_param(my_shared.stabi_param), random_opening(my_shared.random_opening), elite(CompareSolutions), pattern_schedule(SCHEDULE_ROUND_ROBIN), rng(my_shared.worker_rngs[worker]), shared(&my_shared),
+	  worker_id(worker), threads(1), island(NULL), migration_interval(0), parallel_patterns(false), support_quantities(false), checkpoint_interval(0), resumed(false), trace(NULL),
+	  trace_ils(false), current_iteration(0), current_pattern(-1)
+{
+}
 
-// Comparator for ordering moves by improvement
-struct MoveComparator
+void WL_MRILS::Run()
 {
-	bool operator()(Move m1, Move m2)
+	if (resumed)
 	{
-		return m1.improvement < m2.improvement;
+		// Continue the interrupted run, whose state (and elapsed time) was restored by LoadCheckpoint
+		start = chrono::steady_clock::now() - chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(resumed_elapsed));
+		resumed = false;
+	}
+	else
+	{
+		// A best solution from a previous run or re-optimization is kept as a warm start
+		WL_Solution *previous_best = best;
+		best = NULL;
+		start = chrono::steady_clock::now();
+		iteration = 0;
+		evaluations_done = 0;
+		ils_iterations_done = 0;
+		nu_iter = 0;
+		max_nu_iter = 0;
+		elite_updated = false;
+		p = 0;
+		worker_rngs.clear();
+		profile = WL_Profile();
+
+		// Warm start: prior solutions take the best slot and the elite pool right away (they do not count as
+		// iterations for the stagnation criterion)
+		for (unsigned j = 0; j < initial_solutions.size(); j++)
+		{
+			unsigned violations = initial_solutions[j]->ComputeViolations();
+			if (violations)
+			{
+				WL_WARN("initial solution %u ignored: %u violations", j + 1, violations);
+				continue;
+			}
+			UpdatePool(initial_solutions[j]);
+			WL_INFO("initial solution %u: %.2f", j + 1, initial_solutions[j]->Cost());
+		}
+		if (previous_best != NULL)
+		{
+			UpdatePool(previous_best);
+			delete previous_best;
+		}
+		nu_iter = 0;
+		max_nu_iter = 0;
+	}
+	next_migration = Elapsed() + migration_interval;
+	next_checkpoint = Elapsed() + checkpoint_interval;
+
+	// The EA generator is process-wide, so it is seeded once here rather than per worker
+	seedrandom(seed, worker_id);
+
+	// Worker t draws from stream t of the seed (as the sequential search draws from stream 0)
+	// This fixes each worker's random numbers, not the result: which pattern a worker gets, when mining
+	// happens and what the elite pool holds depend on the interleaving of the workers, so runs with several
+	// threads are not reproducible
+	for (unsigned t = worker_rngs.size(); t < threads; t++)
+		worker_rngs.push_back(WL_Random(seed, t));
+
+	if (threads <= 1)
+		Search();
+	else if (parallel_patterns)
+		SearchBatches();
+	else
+	{
+		// Each worker searches on its own copy of the instance, since reduced instances are swapped into it
+		vector<WL_Instance> instances(threads, in);
+		vector<thread> workers;
+		for (unsigned t = 0; t < threads; t++)
+			workers.push_back(thread(&WL_MRILS::Work, this, &instances[t], t));
+		for (unsigned t = 0; t < threads; t++)
+			workers[t].join();
 	}
-};
 
-WL_MRILS::WL_MRILS(WL_Instance &my_in, unsigned timeout, unsigned seed, unsigned elite_max_size, double stabi_param,
-				   double min_sup, unsigned n_patterns, bool random_opening, unsigned ils_maxiter, double ils_accept)
-	: in(my_in), timeout(timeout), seed(seed), elite_max_size(elite_max_size), n_patterns(n_patterns),
-	  ils_maxiter(ils_maxiter), min_sup(min_sup), ils_accept(ils_accept), stabi_param(stabi_param), random_opening(random_opening),
-	  elite(CompareSolutions)
+	if (island && best != NULL)
+		island->Emigrate(*best, time_best, patterns);
+
+	if (!checkpoint_file.empty())
+		SaveCheckpoint();
+}
+
+// Incremental re-optimization: applies `delta` to the instance, repairs the best solution of the previous run
+// locally and improves it with an ILS whose first descent only (re)computes moves for the touched warehouses
+// (those whose data changed, those supplying touched stores and those whose load changed in the repair)
+// The elite pool and the patterns, mined under the old data, are replaced by the new best solution, so a
+// subsequent Run() resumes from it; returns the new best solution (owned by the solver, as Best())
+WL_Solution *WL_MRILS::Reoptimize(const InstanceDelta &delta)
 {
+	vector<Supply> assignment;
+	vector<unsigned> old_load(in.Warehouses(), 0);
+	if (best != NULL)
+	{
+		for (unsigned w = 0; w < in.Warehouses(); w++)
+		{
+			for (auto it = best->supplied_stores[w].begin(); it != best->supplied_stores[w].end(); ++it)
+				assignment.push_back({w, *it, best->Supply(*it, w)});
+			old_load[w] = best->Load(w);
+		}
+		delete best;
+		best = NULL;
+	}
+	EliteClear();
+	patterns.clear();
+	pattern_stats.clear();
+	ClearReduced();
+
+	in.ApplyDelta(delta);
+
+	unordered_set<unsigned> invalid_warehouses;
+	vector<bool> touched_store(in.Stores(), false);
+	for (unsigned i = 0; i < delta.capacities.size(); i++)
+		invalid_warehouses.insert(delta.capacities[i].first);
+	for (unsigned i = 0; i < delta.fixed_costs.size(); i++)
+		invalid_warehouses.insert(delta.fixed_costs[i].first);
+	for (unsigned i = 0; i < delta.supply_costs.size(); i++)
+	{
+		invalid_warehouses.insert(delta.supply_costs[i].w);
+		touched_store[delta.supply_costs[i].s] = true;
+	}
+	for (unsigned i = 0; i < delta.goods.size(); i++)
+		touched_store[delta.goods[i].first] = true;
+	for (unsigned i = 0; i < delta.added_incompatibilities.size(); i++)
+		touched_store[delta.added_incompatibilities[i].first] = touched_store[delta.added_incompatibilities[i].second] = true;
+	for (unsigned i = 0; i < delta.removed_incompatibilities.size(); i++)
+		touched_store[delta.removed_incompatibilities[i].first] = touched_store[delta.removed_incompatibilities[i].second] = true;
+
+	// Keep the previous assignments that are still feasible (up to the new goods and capacities, without
+	// supplying stores that became incompatible from the same warehouse)
+	WL_Solution *sol = new WL_Solution(in);
+	for (unsigned i = 0; i < assignment.size(); i++)
+	{
+		unsigned s = assignment[i].s, w = assignment[i].w;
+		unsigned q = min(assignment[i].q, min(sol->ResidualAmount(s), sol->ResidualCapacity(w)));
+		if (q && !sol->Incompatibilities(w, s))
+			sol->Assign(s, w, q);
+	}
+
+	// Assign the remaining goods greedily (cheapest open warehouse, else cheapest warehouse to open),
+	// falling back to augmenting paths
+	for (unsigned s = 0; s < in.Stores(); s++)
+		while (sol->ResidualAmount(s))
+		{
+			unsigned best_w = in.Warehouses();
+			for (unsigned w = 0; w < in.Warehouses(); w++)
+				if (sol->Load(w) && sol->ResidualCapacity(w) && !sol->Incompatibilities(w, s) && (best_w == in.Warehouses() || in.SupplyCost(s, w) < in.SupplyCost(s, best_w)))
+					best_w = w;
+
+			if (best_w == in.Warehouses())
+			{
+				double best_cost = 0;
+				for (unsigned w = 0; w < in.Warehouses(); w++)
+					if (!sol->Load(w) && sol->ResidualCapacity(w) && !sol->Incompatibilities(w, s))
+					{
+						double cost = in.SupplyCost(s, w) + (double)in.FixedCost(w) / min(sol->ResidualAmount(s), sol->ResidualCapacity(w));
+						if (best_w == in.Warehouses() || cost < best_cost)
+						{
+							best_w = w;
+							best_cost = cost;
+						}
+					}
+			}
+
+			if (best_w == in.Warehouses())
+			{
+				if (!RepairAssignment(sol, s))
+				{
+					WL_WARN("re-optimization: goods of store %u cannot be fully assigned", s + 1);
+					break;
+				}
+			}
+			else
+				sol->Assign(s, best_w, min(sol->ResidualAmount(s), sol->ResidualCapacity(best_w)));
+		}
+
+	for (unsigned w = 0; w < in.Warehouses(); w++)
+	{
+		if (sol->Load(w) != old_load[w])
+			invalid_warehouses.insert(w);
+		for (auto it = sol->supplied_stores[w].begin(); it != sol->supplied_stores[w].end(); ++it)
+			if (touched_store[*it])
+				invalid_warehouses.insert(w);
+	}
+
+	start = chrono::steady_clock::now();
+	iteration = 0;
+	evaluations_done = 0;
+	ils_iterations_done = 0;
+	sol = IteratedLocalSearch(sol, &invalid_warehouses);
+	UpdatePool(sol);
+	delete sol;
+
+	return best;
 }
 
-void WL_MRILS::Run()
+// Adds a prior solution (on the instance of this solver, not owned by it) to warm start the next run
+void WL_MRILS::AddInitialSolution(WL_Solution *sol)
+{
+	initial_solutions.push_back(sol);
+}
+
+// Makes this solver an island of an island model: every `migration_interval` seconds it publishes its best
+// solution and patterns and receives those of the previous island (see WL_Island)
+void WL_MRILS::SetIsland(WL_Island *my_island, double my_migration_interval)
+{
+	island = my_island;
+	migration_interval = my_migration_interval;
+}
+
+// Anytime output: `callback` receives every new best solution and the time it was found (with several
+// threads it runs holding the pool lock, so it should return quickly)
+void WL_MRILS::SetImprovementCallback(function<void(const WL_Solution &, double)> callback)
+{
+	improvement_callback = callback;
+}
+
+// Convergence trace: writes a CSV line to `trace` for every improvement of the best solution and, if `ils`,
+// of the best solution of each ILS (time, iteration, costs, violations, phase and pattern of the reduced phase)
+void WL_MRILS::SetTrace(ostream *my_trace, bool ils)
+{
+	trace = my_trace;
+	trace_ils = ils && trace;
+	if (trace)
+		*trace << "time,iteration,cost,supply_cost,opening_cost,violations,phase,pattern,source" << endl;
+}
+
+// Writes a trace line for `sol`, found in `iteration` (on the reduced instance of `pattern`, if not negative)
+void WL_MRILS::Trace(const WL_Solution &sol, const char *source, unsigned iteration, int pattern) const
+{
+	lock_guard<mutex> lock(shared->trace_mutex);
+	*shared->trace << fixed << setprecision(6) << Elapsed() << "," << iteration << "," << setprecision(2) << sol.Cost() << ","
+				   << sol.SupplyCost() << "," << sol.OpeningCost() << "," << sol.ComputeViolations() << ","
+				   << (pattern < 0 ? "original," : "reduced,");
+	if (pattern >= 0)
+		*shared->trace << pattern;
+	*shared->trace << "," << source << "\n";
+}
+
+// Wall-clock time (in seconds) since the start of the run
+double WL_MRILS::Elapsed() const
+{
+	return chrono::duration<double>(chrono::steady_clock::now() - shared->start).count();
+}
+
+// Fraction of the work budget used (of the timeout, if there is no work budget)
+// (reads the iteration counter, so it must be called holding `pool_mutex` of `shared`, or with no workers running)
+double WL_MRILS::Progress() const
+{
+	const WL_Budget &budget = shared->budget;
+	if (!budget.iterations && !budget.evaluations && !budget.ils_iterations)
+		return Elapsed() / timeout;
+
+	double progress = 0;
+	if (budget.iterations)
+		progress = max(progress, (double)shared->iteration / budget.iterations);
+	if (budget.evaluations)
+		progress = max(progress, (double)shared->evaluations_done / budget.evaluations);
+	if (budget.ils_iterations)
+		progress = max(progress, (double)shared->ils_iterations_done / budget.ils_iterations);
+	return progress;
+}
+
+// Whether the time, the move evaluations or the ILS iterations of the run are used up
+// (the iteration budget is checked by Search when starting an iteration)
+bool WL_MRILS::Exhausted() const
+{
+	const WL_Budget &budget = shared->budget;
+	return Elapsed() >= timeout || (budget.evaluations && shared->evaluations_done >= budget.evaluations)
+		|| (budget.ils_iterations && shared->ils_iterations_done >= budget.ils_iterations);
+}
+
+// Worker thread: runs the multi-start loop on `instance`, publishing into the elite pool of this solver
+void WL_MRILS::Work(WL_Instance *instance, unsigned worker_id)
+{
+	WL_MRILS worker(*this, *instance, worker_id);
+	worker.Search();
+
+	lock_guard<mutex> lock(pool_mutex);
+	profile.Add(worker.profile);
+}
+
+// Multi-start loop (of a single worker, in parallel mode)
+// Iterations are independent apart from the elite pool, the patterns mined from it and the best solution,
+// which belong to `shared` and are only accessed while holding its `pool_mutex`
+void WL_MRILS::Search()
+{
+	while (!Exhausted())
+	{
+		int p = -1;
+		vector<Supply> pattern;
+
+		{
+			lock_guard<mutex> lock(shared->pool_mutex);
+
+			if (!StartIteration())
+				break;
+			current_iteration = shared->iteration;
+
+			if (!shared->patterns.empty())
+			{
+				p = shared->NextPattern(rng);
+				pattern = shared->patterns[p];
+			}
+		}
+
+		Iterate(p, pattern);
+	}
+}
+
+// Batch search (parallel pattern mode): each step dispatches to a thread pool the reduced solves of all the
+// current patterns (before the first mining, `threads` iterations from new constructions), each one an
+// iteration run by its own worker, and waits for them; a mining cycle thus takes about as long as its
+// slowest pattern instead of the sum of all of them
+void WL_MRILS::SearchBatches()
+{
+	WL_ThreadPool pool(threads);
+	vector<WL_Instance> instances; // instance of the worker of each task of a batch (reduced instances are swapped into it)
+
+	while (!Exhausted())
+	{
+		vector<pair<int, vector<Supply>>> batch; // (pattern index or -1, pattern) of each task
+		vector<unsigned> batch_iterations;
+
+		{
+			lock_guard<mutex> lock(pool_mutex);
+
+			// Migration and mining may only happen when the first iteration of a batch starts: the other
+			// iterations are started without them, so the patterns do not change while the batch is built
+			if (!StartIteration())
+				break;
+			unsigned size = patterns.empty() ? threads : patterns.size();
+			for (unsigned k = 0; k < size; k++)
+			{
+				if (!patterns.empty() && pattern_stats[k].retired)
+					continue;
+				if (!batch.empty() && !StartIteration(false))
+					break;
+				batch_iterations.push_back(iteration);
+				if (patterns.empty())
+					batch.push_back(make_pair(-1, vector<Supply>()));
+				else
+				{
+					batch.push_back(make_pair((int)k, patterns[k]));
+					pattern_stats[k].dispatched++;
+				}
+			}
+
+			for (unsigned t = worker_rngs.size(); t < batch.size(); t++)
+				worker_rngs.push_back(WL_Random(seed, t));
+		}
+
+		while (instances.size() < batch.size())
+			instances.push_back(in);
+		for (unsigned k = 0; k < batch.size(); k++)
+			pool.Submit([this, k, &batch, &batch_iterations, &instances]()
+			{
+				WL_MRILS worker(*this, instances[k], k);
+				worker.current_iteration = batch_iterations[k];
+				worker.Iterate(batch[k].first, batch[k].second);
+
+				lock_guard<mutex> lock(pool_mutex);
+				profile.Add(worker.profile);
+			});
+		pool.Wait();
+	}
+}
+
+// Starts an iteration of the run: checks the iteration budget and, if `maintenance`, migrates and mines the
+// elite pool when due
+// Returns false if the iteration budget is used up (must be called holding `pool_mutex` of `shared`)
+bool WL_MRILS::StartIteration(bool maintenance)
 {
-	test();
+	if (shared->budget.iterations && shared->iteration >= shared->budget.iterations)
+		return false;
 
-	best = NULL;
+	++shared->iteration;
+	WL_DEBUG("iteration %u", shared->iteration);
+	profile.iterations++;
+	if (!maintenance)
+		return true;
 
-	unsigned i = 0;
-	unsigned nu_iter = 0;
-	unsigned max_nu_iter = 0;
-	bool elite_updated = false;
-	unsigned p = 0;
+	if (shared->island && Elapsed() >= shared->next_migration)
+		shared->Migrate();
 
-	while (clock() / CLOCKS_PER_SEC < timeout)
+	if (elite_max_size && shared->elite_updated && (shared->nu_iter > shared->max_nu_iter || (shared->elite.size() == elite_max_size && shared->patterns.empty() && Progress() > 0.5)))
 	{
-		i++;
+		WL_Timer timer(profile.mining_time);
+		shared->MineElite();
+		timer.Stop();
+		profile.minings++;
+		profile.patterns_mined += shared->patterns.size();
+		shared->elite_updated = false;
+		shared->p = 0;
+		WL_INFO("mined %u patterns from %u elite solutions", (unsigned)shared->patterns.size(), (unsigned)shared->elite.size());
+	}
 
-		cout << "iteration " << i << endl;
+	return true;
+}
 
-		if (elite_max_size && elite_updated && (nu_iter > max_nu_iter || (elite.size() == elite_max_size && patterns.empty() && clock() / CLOCKS_PER_SEC > timeout / 2)))
+// Runs the current iteration: the ILS on the original instance from a new construction (if `p` < 0) or from
+// the solution of the reduced instance of `pattern` (pattern `p`) lifted back, then publishes its result
+void WL_MRILS::Iterate(int p, const vector<Supply>& pattern)
+{
+	WL_Instance *original_instance = NULL;
+	vector<Supply> reduced_best;
+	current_pattern = p;
+	double seconds = 0;
+	WL_Timer iteration_timer(seconds);
+
+	if (p >= 0)
+	{
+		lock_guard<mutex> lock(shared->pool_mutex);
+		WL_Timer timer(profile.reduced_instance_time);
+		original_instance = new WL_Instance(in);
+		ReducedEntry& reduced = shared->Reduced(pattern);
+		in = reduced.instance;
+		if (reduced.solved)
 		{
-			cout << "mining elite..." << flush;
-			MineElite();
-			reduced_instances.clear();
-			elite_updated = false;
-			p = 0;
-			cout << " finished" << endl;
+			reduced_best = reduced.best;
+			profile.reduced_warm_starts++;
 		}
+		profile.reduced_iterations++;
+	}
 
-		WL_Solution *sol;
-		if (patterns.empty())
+	WL_Solution *sol;
+	if (!original_instance)
+	{
+		sol = InitialSolution();
+		WL_DEBUG("iteration %u: initial solution %.2f", current_iteration, sol->Cost());
+	}
+	else
+	{
+		// The reduced ILS resumes from the best solution found on the same pattern in earlier iterations, if any
+		WL_Solution *reduced_sol;
+		if (reduced_best.empty())
 		{
-			cout << "generating initial solution..." << flush;
-			sol = InitialSolution();
-			cout << " finished" << endl;
+			reduced_sol = InitialSolution();
+			WL_DEBUG("iteration %u: initial solution %.2f (pattern %d)", current_iteration, reduced_sol->Cost(), current_pattern);
 		}
 		else
 		{
-			WL_Instance original_instance = in;
-			in = ReducedInstance(p);
+			reduced_sol = new WL_Solution(in);
+			for (unsigned j = 0; j < reduced_best.size(); j++)
+				reduced_sol->Assign(reduced_best[j].s, reduced_best[j].w, reduced_best[j].q);
+			WL_DEBUG("iteration %u: warm start %.2f (pattern %d)", current_iteration, reduced_sol->Cost(), current_pattern);
+		}
+		reduced_sol = IteratedLocalSearch(reduced_sol);
+		WL_DEBUG("iteration %u: local search %.2f (pattern %d)", current_iteration, reduced_sol->Cost(), current_pattern);
+		{
+			lock_guard<mutex> lock(shared->pool_mutex);
+			shared->UpdateReduced(pattern, *reduced_sol);
+		}
 
-			cout << "generating initial solution (reduced)..." << flush;
-			WL_Solution *reduced_sol = InitialSolution();
-			cout << " finished" << endl;
-			cout << "local search (reduced)..." << flush;
-			reduced_sol = IteratedLocalSearch(reduced_sol);
-			cout << " finished" << endl;
+		in = *original_instance;
+		delete original_instance;
+		sol = new WL_Solution(in);
+		for (unsigned w = 0; w < in.Warehouses(); w++)
+			for (auto it = reduced_sol->supplied_stores[w].begin(); it != reduced_sol->supplied_stores[w].end(); ++it)
+			{
+				unsigned s = *it;
+				sol->Assign(s, w, reduced_sol->Supply(s, w));
+			}
 
-			in = original_instance;
-			sol = new WL_Solution(in);
-			for (unsigned w = 0; w < in.Warehouses(); w++)
-				for (auto it = reduced_sol->supplied_stores[w].begin(); it != reduced_sol->supplied_stores[w].end(); ++it)
-				{
-					unsigned s = *it;
-					sol->Assign(s, w, reduced_sol->Supply(s, w));
-				}
-			for (unsigned j = 0; j < patterns[p].size(); j++)
-				sol->Assign(patterns[p][j].s, patterns[p][j].w, patterns[p][j].q);
+		for (unsigned j = 0; j < pattern.size(); j++)
+			sol->Assign(pattern[j].s, pattern[j].w, pattern[j].q);
 
-			delete reduced_sol;
-			p = (p + 1) % patterns.size();
+		delete reduced_sol;
+	}
+
+	sol = IteratedLocalSearch(sol);
+	WL_DEBUG("iteration %u: local search %.2f", current_iteration, sol->Cost());
+	iteration_timer.Stop();
+
+	{
+		lock_guard<mutex> lock(shared->pool_mutex);
+		shared->UpdatePool(sol, this);
+		if (p >= 0)
+			shared->RecordPattern(p, pattern, sol->Cost(), seconds);
+
+		if (shared != this)
+			shared->worker_rngs[worker_id] = rng;
+
+		if (!shared->checkpoint_file.empty() && Elapsed() >= shared->next_checkpoint)
+		{
+			shared->SaveCheckpoint();
+			shared->next_checkpoint = Elapsed() + shared->checkpoint_interval;
 		}
+	}
 
-		cout << "local search..." << flush;
-		sol = IteratedLocalSearch(sol);
-		cout << " finished" << endl;
+	delete sol;
+}
+
+// Island migration: publishes the best solution and the patterns of this island, then inserts the
+// solution received from the previous island into the elite pool and appends its new patterns to the
+// round-robin of reduced searches (must be called holding `pool_mutex`)
+void WL_MRILS::Migrate()
+{
+	if (best != NULL)
+		island->Emigrate(*best, time_best, patterns);
+
+	WL_Solution *migrant;
+	vector<vector<Supply>> migrant_patterns;
+	if (island->Immigrate(in, &migrant, &migrant_patterns))
+	{
+		if (migrant)
+		{
+			WL_INFO("immigrant from island %u: %.2f", (island->Id() + island->Islands() - 1) % island->Islands(), migrant->Cost());
+			UpdatePool(migrant);
+			delete migrant;
+		}
 
-		if (elite_max_size)
+		for (unsigned i = 0; i < migrant_patterns.size(); i++)
 		{
-			nu_iter++;
-			unsigned old_elite_size = elite.size();
-			elite.insert(*sol);
-			if (elite.size() > elite_max_size)
+			bool known = false;
+			for (unsigned j = 0; !known && j < patterns.size(); j++)
 			{
-				set<WL_Solution>::iterator it = --elite.end();
-				if (it->Cost() - MY_EPSILON > sol->Cost())
-				{
-					nu_iter = 0;
-					elite_updated = true;
-				}
-				elite.erase(it);
+				known = patterns[j].size() == migrant_patterns[i].size();
+				for (unsigned k = 0; known && k < patterns[j].size(); k++)
+					known = patterns[j][k].w == migrant_patterns[i][k].w && patterns[j][k].s == migrant_patterns[i][k].s && patterns[j][k].q == migrant_patterns[i][k].q;
 			}
-			else if (elite.size() > old_elite_size)
+			if (!known)
+			{
+				patterns.push_back(migrant_patterns[i]);
+				pattern_stats.push_back({0, 0, 0, 0, EliteSupport(migrant_patterns[i]), false});
+			}
+		}
+	}
+
+	next_migration = Elapsed() + migration_interval;
+}
+
+// Inserts `sol` into the elite pool and updates the best solution and the stagnation threshold
+// `finder` is the solver (or worker) whose current iteration found `sol`, for the trace; NULL for solutions
+// from outside the search (warm starts, immigrants and re-optimized solutions)
+// Stored solutions are bound to the instance of this solver, as the instance of a worker changes
+// between original and reduced versions (must be called holding `pool_mutex`)
+void WL_MRILS::UpdatePool(WL_Solution *sol, const WL_MRILS *finder)
+{
+	if (elite_max_size)
+	{
+		nu_iter++;
+		bool inserted = EliteInsert(WL_Solution(sol, in));
+		if (elite.size() > elite_max_size)
+		{
+			set<WL_Solution>::iterator it = --elite.end();
+			if (it->Cost() - MY_EPSILON > sol->Cost())
 			{
 				nu_iter = 0;
 				elite_updated = true;
 			}
+			EliteErase(it);
 		}
-
-		if (best == NULL || sol->Cost() < best->Cost() - MY_EPSILON)
+		else if (inserted)
 		{
-			time_best = (double)clock() / CLOCKS_PER_SEC;
+			nu_iter = 0;
+			elite_updated = true;
+		}
+	}
 
-			if (best != NULL)
-				delete best;
+	if (best == NULL || sol->Cost() < best->Cost() - MY_EPSILON)
+	{
+		time_best = Elapsed();
 
-			best = sol->Copy();
-		}
+		if (best != NULL)
+			delete best;
 
-		delete sol;
+		best = new WL_Solution(sol, in);
+		WL_INFO("best solution %.2f at %.1f s", best->Cost(), time_best);
 
-		unsigned est_n_iter = min(1000, (int)(timeout / (((double)clock() / CLOCKS_PER_SEC) / i)));
+		if (improvement_callback)
+			improvement_callback(*best, time_best);
+		if (trace)
+		{
+			if (finder != NULL)
+				Trace(*best, "best", finder->current_iteration, finder->current_pattern);
+			else
+				Trace(*best, "best", iteration, -1);
+		}
+	}
+
+	double progress = Progress();
+	if (iteration && progress > 0)
+	{
+		unsigned est_n_iter = min(1000.0, iteration / progress);
 		max_nu_iter = stabi_param * est_n_iter;
 	}
 }
@@ -168,6 +649,9 @@ void WL_MRILS::Run()
 // Generates an initial solution
 WL_Solution *WL_MRILS::InitialSolution()
 {
+	WL_Timer timer(profile.construction_time);
+	profile.constructions++;
+
 	if (random_opening)
 		return InitialSolutionRandomOpening();
 
@@ -207,14 +691,14 @@ WL_Solution *WL_MRILS::InitialSolutionGreedyOpening()
 		{
 			if (sol->ResidualCapacity(warehouses[w]))
 			{
-				unsigned s = rand() % in.Stores();
+				unsigned s = rng.Below(in.Stores());
 				unsigned trials = 0;
 				while (!sol->ResidualAmount(s) || sol->Incompatibilities(warehouses[w], s))
 				{
 					if (++trials > in.Stores())
 						break;
 
-					s = rand() % in.Stores();
+					s = rng.Below(in.Stores());
 				}
 
 				if (trials <= in.Stores())
@@ -248,6 +732,23 @@ WL_Solution *WL_MRILS::InitialSolutionGreedyOpening()
 					}
 					else
 					{
+						vector<unsigned> opened;
+						if (RepairAssignment(sol, s, &opened))
+						{
+							// Move warehouses opened by the repair to the open part of the ordering
+							for (unsigned i = 0; i < opened.size(); i++)
+							{
+								unsigned next = find(warehouses.begin(), warehouses.end(), opened[i]) - warehouses.begin();
+								if (next <= last_open)
+									continue;
+								last_open++;
+								for (unsigned j = next; j > last_open; j--)
+									warehouses[j] = warehouses[j - 1];
+								warehouses[last_open] = opened[i];
+							}
+							break;
+						}
+
 						feasible = false;
 						delete sol;
 						break;
@@ -268,57 +769,44 @@ WL_Solution *WL_MRILS::InitialSolutionRandomOpening()
 	WL_Solution *sol;
 	bool feasible = false;
 
+	// Selection weights (capacity to fixed-cost ratio) are the same for every restart
+	vector<double> weights(in.Warehouses());
+	for (unsigned w = 0; w < in.Warehouses(); w++)
+		weights[w] = in.FixedCost(w) ? (double)in.Capacity(w) / in.FixedCost(w) : (double)in.Capacity(w);
+
+	unsigned total_demand = 0;
+	for (unsigned s = 0; s < in.Stores(); s++)
+		total_demand += in.AmountOfGoods(s);
+
 	while (!feasible)
 	{
 		sol = new WL_Solution(in);
 		feasible = true;
 
-		vector<unsigned> warehouses(in.Warehouses());
-		double relative_cost_sum = 0;
-		for (unsigned w = 0; w < in.Warehouses(); w++)
-		{
-			warehouses[w] = w;
-			relative_cost_sum += in.FixedCost(w) ? (double)in.Capacity(w) / in.FixedCost(w) : (double)in.Capacity(w);
-		}
+		WL_Roulette roulette(weights); // unopened warehouses
+		vector<unsigned> warehouses;   // opened warehouses, in opening order
 
-		unsigned total_demand = 0;
-		for (unsigned s = 0; s < in.Stores(); s++)
-			total_demand += in.AmountOfGoods(s);
-
-		int last_open = -1;
 		unsigned total_capacity = 0;
-		while (total_capacity < total_demand)
+		while (total_capacity < total_demand && !roulette.Empty())
 		{
-			double random = (double)rand() / RAND_MAX;
-			double cumulative_prob = 0;
-			for (unsigned w = last_open + 1; w < in.Warehouses(); w++)
-			{
-				double selection_prob = (in.FixedCost(warehouses[w]) ? (double)in.Capacity(warehouses[w]) / in.FixedCost(warehouses[w]) : (double)in.Capacity(warehouses[w])) / relative_cost_sum;
-				if (random <= cumulative_prob + selection_prob)
-				{
-					unsigned temp = warehouses[++last_open];
-					warehouses[last_open] = warehouses[w];
-					warehouses[w] = temp;
-					total_capacity += in.Capacity(warehouses[last_open]);
-					relative_cost_sum -= in.FixedCost(warehouses[last_open]) ? (double)in.Capacity(warehouses[last_open]) / in.FixedCost(warehouses[last_open]) : (double)in.Capacity(warehouses[last_open]);
-					break;
-				}
-				cumulative_prob += selection_prob;
-			}
+			unsigned w = roulette.Sample(rng.Uniform());
+			roulette.Remove(w);
+			warehouses.push_back(w);
+			total_capacity += in.Capacity(w);
 		}
 
-		for (int w = 0; w <= last_open; w++)
+		for (unsigned w = 0; w < warehouses.size(); w++)
 		{
 			if (sol->ResidualCapacity(warehouses[w]))
 			{
-				unsigned s = rand() % in.Stores();
+				unsigned s = rng.Below(in.Stores());
 				unsigned trials = 0;
 				while (!sol->ResidualAmount(s) || sol->Incompatibilities(warehouses[w], s))
 				{
 					if (++trials > in.Stores())
 						break;
 
-					s = rand() % in.Stores();
+					s = rng.Below(in.Stores());
 				}
 
 				if (trials <= in.Stores())
@@ -331,38 +819,44 @@ WL_Solution *WL_MRILS::InitialSolutionRandomOpening()
 			while (sol->ResidualAmount(s))
 			{
 				unsigned best_w = in.Warehouses();
-				for (int w = 0; w <= last_open; w++)
+				for (unsigned w = 0; w < warehouses.size(); w++)
 					if (sol->ResidualCapacity(warehouses[w]) && !sol->Incompatibilities(warehouses[w], s) && (best_w == in.Warehouses() || in.SupplyCost(s, warehouses[w]) < in.SupplyCost(s, best_w)))
 						best_w = warehouses[w];
 
 				if (best_w == in.Warehouses())
 				{
-					if (last_open < (int)in.Warehouses() - 1)
-						while (best_w == in.Warehouses())
+					// Sample unopened warehouses until one can supply `s`; the ones that cannot
+					// are left out of the roulette meanwhile, so the sampling always terminates
+					vector<unsigned> skipped;
+					while (best_w == in.Warehouses() && !roulette.Empty())
+					{
+						unsigned w = roulette.Sample(rng.Uniform());
+						roulette.Remove(w);
+						if (sol->ResidualCapacity(w) && !sol->Incompatibilities(w, s))
 						{
-							double random = (double)rand() / RAND_MAX;
-							double cumulative_prob = 0;
-							for (unsigned w = last_open + 1; w < in.Warehouses(); w++)
-							{
-								double selection_prob = (in.FixedCost(warehouses[w]) ? (double)in.Capacity(warehouses[w]) / in.FixedCost(warehouses[w]) : (double)in.Capacity(warehouses[w])) / relative_cost_sum;
-								if (random <= cumulative_prob + selection_prob)
+							warehouses.push_back(w);
+							best_w = w;
+						}
+						else
+							skipped.push_back(w);
+					}
+					for (unsigned i = 0; i < skipped.size(); i++)
+						roulette.Update(skipped[i], weights[skipped[i]]);
+
+					if (best_w == in.Warehouses())
+					{
+						vector<unsigned> opened;
+						if (RepairAssignment(sol, s, &opened))
+						{
+							for (unsigned i = 0; i < opened.size(); i++)
+								if (roulette.Weight(opened[i]) > 0)
 								{
-									if (sol->ResidualCapacity(warehouses[w]) && !sol->Incompatibilities(warehouses[w], s))
-									{
-										unsigned temp = warehouses[++last_open];
-										warehouses[last_open] = warehouses[w];
-										warehouses[w] = temp;
-										total_capacity += in.Capacity(warehouses[last_open]);
-										relative_cost_sum -= in.FixedCost(warehouses[last_open]) ? (double)in.Capacity(warehouses[last_open]) / in.FixedCost(warehouses[last_open]) : (double)in.Capacity(warehouses[last_open]);
-										best_w = warehouses[last_open];
-									}
-									break;
+									roulette.Remove(opened[i]);
+									warehouses.push_back(opened[i]);
 								}
-								cumulative_prob += selection_prob;
-							}
+							break;
 						}
-					else
-					{
+
 						feasible = false;
 						delete sol;
 						break;
@@ -377,118 +871,234 @@ WL_Solution *WL_MRILS::InitialSolutionRandomOpening()
 	return sol;
 }
 
-// Local search using a priority queue of improving moves and multi improvement strategy
-void WL_MRILS::LocalSearch(WL_Solution *sol)
+// Places the residual amount of goods of store `s` through augmenting paths, used when no warehouse
+// can receive `s` directly (because of capacity or incompatibilities)
+// A path s -> w0, s1: w0 -> w1, ..., sk: w(k-1) -> wk moves goods of each store s(i) out of w(i-1) into w(i),
+// so that w0 receives `s` and the last warehouse wk, the only one whose load grows, has residual capacity
+// Warehouses opened by the repair (load 0 before) are appended to `opened`
+// Returns true if all goods of `s` were assigned
+bool WL_MRILS::RepairAssignment(WL_Solution *sol, unsigned s, vector<unsigned> *opened)
 {
-	unordered_set<unsigned> invalid_warehouses;
+	while (sol->ResidualAmount(s))
+	{
+		// BFS over warehouses: `parent[w]` is the previous warehouse in the path and `mover[w]` is the store
+		// moved from `parent[w]` into `w` (`parent[w]` is in.Warehouses() for warehouses receiving `s` itself)
+		vector<unsigned> parent(in.Warehouses(), in.Warehouses()), mover(in.Warehouses(), in.Stores());
+		vector<bool> visited(in.Warehouses(), false);
+		queue<unsigned> frontier;
+		unsigned last = in.Warehouses();
+
+		for (unsigned w = 0; last == in.Warehouses() && w < in.Warehouses(); w++)
+			if (in.Capacity(w) && !sol->Incompatibilities(w, s))
+			{
+				visited[w] = true;
+				mover[w] = s;
+				if (sol->ResidualCapacity(w))
+					last = w;
+				else
+					frontier.push(w);
+			}
 
-	for (unsigned w = 0; w < in.Warehouses(); w++)
-		invalid_warehouses.insert(w);
+		while (last == in.Warehouses() && !frontier.empty())
+		{
+			unsigned w1 = frontier.front();
+			frontier.pop();
 
-	priority_queue<Move, vector<Move>, MoveComparator> moves;
+			for (auto it = sol->supplied_stores[w1].begin(); last == in.Warehouses() && it != sol->supplied_stores[w1].end(); ++it)
+			{
+				unsigned s1 = *it;
+				if (s1 == s)
+					continue;
 
-	while (clock() / CLOCKS_PER_SEC < timeout)
-	{
-		// (Re)compute moves for invalid warehouses
+				for (unsigned w2 = 0; last == in.Warehouses() && w2 < in.Warehouses(); w2++)
+					if (!visited[w2] && in.Capacity(w2) && !sol->Incompatibilities(w2, s1))
+					{
+						visited[w2] = true;
+						parent[w2] = w1;
+						mover[w2] = s1;
+						if (sol->ResidualCapacity(w2))
+							last = w2;
+						else
+							frontier.push(w2);
+					}
+			}
+		}
+
+		if (last == in.Warehouses())
+			return false;
 
-		for (auto it = invalid_warehouses.begin(); it != invalid_warehouses.end(); ++it)
+		// Bottleneck quantity along the path
+		unsigned q = min(sol->ResidualAmount(s), sol->ResidualCapacity(last));
+		for (unsigned w = last; parent[w] != in.Warehouses(); w = parent[w])
+			q = min(q, sol->Supply(mover[w], parent[w]));
+
+		if (opened && !sol->Load(last))
+			opened->push_back(last);
+
+		// Apply the moves from the end of the path, so capacities are never exceeded
+		unsigned w = last;
+		for (; parent[w] != in.Warehouses(); w = parent[w])
 		{
-			unsigned w1 = *it;
-			if (sol->Load(w1))
-				for (auto it2 = sol->supplied_stores[w1].begin(); it2 != sol->supplied_stores[w1].end(); ++it2)
-				{
-					unsigned s1 = *it2;
-					for (unsigned w2 = 0; w2 < in.Warehouses(); w2++)
-						if (w1 != w2)
+			sol->RevokeAssignment(mover[w], parent[w], q);
+			sol->Assign(mover[w], w, q);
+		}
+		sol->Assign(s, w, q);
+	}
+
+	return true;
+}
+
+// Pushes the improving moves that involve the warehouses in `invalid_warehouses` (as origin or destination),
+// without opening warehouses in `opening_forbidden` or counting the fixed cost saved by closing warehouses
+// in `closing_forbidden`
+void WL_MRILS::ComputeMoves(const WL_Solution *sol, const unordered_set<unsigned> &invalid_warehouses, const unordered_set<unsigned> &closing_forbidden,
+							const unordered_set<unsigned> &opening_forbidden, MoveQueue *moves)
+{
+	unsigned long long evaluated = profile.moves_evaluated;
+
+	for (auto it = invalid_warehouses.begin(); it != invalid_warehouses.end(); ++it)
+	{
+		unsigned w1 = *it;
+		if (sol->Load(w1))
+			for (auto it2 = sol->supplied_stores[w1].begin(); it2 != sol->supplied_stores[w1].end(); ++it2)
+			{
+				unsigned s1 = *it2;
+				for (unsigned w2 = 0; w2 < in.Warehouses(); w2++)
+					if (w1 != w2 && opening_forbidden.find(w2) == opening_forbidden.end())
+					{
+						// Neighborhood 1: solutions that can be obtained from `sol` by relocating the allowed maximum
+						// quantity of goods supplied to a store (s1) from one warehouse (w1) to another (w2)
+						if (!sol->Incompatibilities(w2, s1) && sol->ResidualCapacity(w2))
 						{
-							// Neighborhood 1: solutions that can be obtained from `sol` by relocating the allowed maximum
-							// quantity of goods supplied to a store (s1) from one warehouse (w1) to another (w2)
-							if (!sol->Incompatibilities(w2, s1) && sol->ResidualCapacity(w2))
+							unsigned q = min(sol->Supply(s1, w1), sol->ResidualCapacity(w2));
+							double improvement = (in.SupplyCost(s1, w1) - in.SupplyCost(s1, w2)) * q;
+							if (!sol->Load(w2))
+								improvement -= in.FixedCost(w2);
+							if (q == sol->Load(w1) && closing_forbidden.find(w1) == closing_forbidden.end())
+								improvement += in.FixedCost(w1);
+
+							profile.moves_evaluated++;
+							if (improvement > MY_EPSILON)
 							{
-								unsigned q = min(sol->Supply(s1, w1), sol->ResidualCapacity(w2));
-								double improvement = (in.SupplyCost(s1, w1) - in.SupplyCost(s1, w2)) * q;
-								if (!sol->Load(w2))
-									improvement -= in.FixedCost(w2);
-								if (q == sol->Load(w1))
-									improvement += in.FixedCost(w1);
-
-								if (improvement > MY_EPSILON)
-									moves.push({s1, in.Stores(), w1, w2, improvement});
+								moves->push({s1, in.Stores(), w1, w2, improvement});
+								profile.moves_pushed++;
 							}
+						}
 
-							// Neighborhood 2: solutions that can be obtained from `sol` by exchanging one store (s1)
-							// from one warehouse (w1) with another store (s2) from another warehouse (w2)
-							if (sol->Incompatibilities(w2, s1) <= 1)
-								for (auto it3 = sol->supplied_stores[w2].begin(); it3 != sol->supplied_stores[w2].end(); ++it3)
+						// Neighborhood 2: solutions that can be obtained from `sol` by exchanging one store (s1)
+						// from one warehouse (w1) with another store (s2) from another warehouse (w2)
+						if (sol->Incompatibilities(w2, s1) <= 1)
+							for (auto it3 = sol->supplied_stores[w2].begin(); it3 != sol->supplied_stores[w2].end(); ++it3)
+							{
+								unsigned s2 = *it3;
+								if (s1 != s2 && ((!sol->Incompatibilities(w1, s2) && !sol->Incompatibilities(w2, s1)) || (sol->Incompatibilities(w1, s2) == 1 && in.Incompatible(s1, s2))) && sol->Supply(s1, w1) <= sol->ResidualCapacity(w2) + sol->Supply(s2, w2) && sol->Supply(s2, w2) <= sol->ResidualCapacity(w1) + sol->Supply(s1, w1))
 								{
-									unsigned s2 = *it3;
-									if (s1 != s2 && ((!sol->Incompatibilities(w1, s2) && !sol->Incompatibilities(w2, s1)) || (sol->Incompatibilities(w1, s2) == 1 && in.Incompatible(s1, s2))) && sol->Supply(s1, w1) <= sol->ResidualCapacity(w2) + sol->Supply(s2, w2) && sol->Supply(s2, w2) <= sol->ResidualCapacity(w1) + sol->Supply(s1, w1))
-									{
-										double improvement = (in.SupplyCost(s1, w1) - in.SupplyCost(s1, w2)) * sol->Supply(s1, w1) + (in.SupplyCost(s2, w2) - in.SupplyCost(s2, w1)) * sol->Supply(s2, w2);
+									double improvement = (in.SupplyCost(s1, w1) - in.SupplyCost(s1, w2)) * sol->Supply(s1, w1) + (in.SupplyCost(s2, w2) - in.SupplyCost(s2, w1)) * sol->Supply(s2, w2);
 
-										if (improvement > MY_EPSILON)
-											moves.push({s1, s2, w1, w2, improvement});
+									profile.moves_evaluated++;
+									if (improvement > MY_EPSILON)
+									{
+										moves->push({s1, s2, w1, w2, improvement});
+										profile.moves_pushed++;
 									}
 								}
-						}
-				}
-		}
+							}
+					}
+			}
+	}
 
-		for (unsigned w1 = 0; w1 < in.Warehouses(); w1++)
-			if (sol->Load(w1))
-				for (auto it = sol->supplied_stores[w1].begin(); it != sol->supplied_stores[w1].end(); ++it)
+	for (unsigned w1 = 0; w1 < in.Warehouses(); w1++)
+		if (sol->Load(w1))
+			for (auto it = sol->supplied_stores[w1].begin(); it != sol->supplied_stores[w1].end(); ++it)
+			{
+				unsigned s1 = *it;
+				for (auto it2 = invalid_warehouses.begin(); it2 != invalid_warehouses.end(); ++it2)
 				{
-					unsigned s1 = *it;
-					for (auto it2 = invalid_warehouses.begin(); it2 != invalid_warehouses.end(); ++it2)
+					unsigned w2 = *it2;
+					if (w1 != w2 && opening_forbidden.find(w2) == opening_forbidden.end())
 					{
-						unsigned w2 = *it2;
-						if (w1 != w2)
+						// Neighborhood 1: solutions that can be obtained from `sol` by relocating the allowed maximum
+						// quantity of goods supplied to a store (s1) from one warehouse (w1) to another (w2)
+						if (!sol->Incompatibilities(w2, s1) && sol->ResidualCapacity(w2))
 						{
-							// Neighborhood 1: solutions that can be obtained from `sol` by relocating the allowed maximum
-							// quantity of goods supplied to a store (s1) from one warehouse (w1) to another (w2)
-							if (!sol->Incompatibilities(w2, s1) && sol->ResidualCapacity(w2))
+							unsigned q = min(sol->Supply(s1, w1), sol->ResidualCapacity(w2));
+							double improvement = (in.SupplyCost(s1, w1) - in.SupplyCost(s1, w2)) * q;
+							if (!sol->Load(w2))
+								improvement -= in.FixedCost(w2);
+							if (q == sol->Load(w1) && closing_forbidden.find(w1) == closing_forbidden.end())
+								improvement += in.FixedCost(w1);
+
+							profile.moves_evaluated++;
+							if (improvement > MY_EPSILON)
 							{
-								unsigned q = min(sol->Supply(s1, w1), sol->ResidualCapacity(w2));
-								double improvement = (in.SupplyCost(s1, w1) - in.SupplyCost(s1, w2)) * q;
-								if (!sol->Load(w2))
-									improvement -= in.FixedCost(w2);
-								if (q == sol->Load(w1))
-									improvement += in.FixedCost(w1);
-
-								if (improvement > MY_EPSILON)
-									moves.push({s1, in.Stores(), w1, w2, improvement});
+								moves->push({s1, in.Stores(), w1, w2, improvement});
+								profile.moves_pushed++;
 							}
+						}
 
-							// Neighborhood 2: solutions that can be obtained from `sol` by exchanging one store (s1)
-							// from one warehouse (w1) with another store (s2) from another warehouse (w2)
-							if (sol->Incompatibilities(w2, s1) <= 1)
-								for (auto it3 = sol->supplied_stores[w2].begin(); it3 != sol->supplied_stores[w2].end(); ++it3)
+						// Neighborhood 2: solutions that can be obtained from `sol` by exchanging one store (s1)
+						// from one warehouse (w1) with another store (s2) from another warehouse (w2)
+						if (sol->Incompatibilities(w2, s1) <= 1)
+							for (auto it3 = sol->supplied_stores[w2].begin(); it3 != sol->supplied_stores[w2].end(); ++it3)
+							{
+								unsigned s2 = *it3;
+								if (s1 != s2 && ((!sol->Incompatibilities(w1, s2) && !sol->Incompatibilities(w2, s1)) || (sol->Incompatibilities(w1, s2) == 1 && in.Incompatible(s1, s2))) && sol->Supply(s1, w1) <= sol->ResidualCapacity(w2) + sol->Supply(s2, w2) && sol->Supply(s2, w2) <= sol->ResidualCapacity(w1) + sol->Supply(s1, w1))
 								{
-									unsigned s2 = *it3;
-									if (s1 != s2 && ((!sol->Incompatibilities(w1, s2) && !sol->Incompatibilities(w2, s1)) || (sol->Incompatibilities(w1, s2) == 1 && in.Incompatible(s1, s2))) && sol->Supply(s1, w1) <= sol->ResidualCapacity(w2) + sol->Supply(s2, w2) && sol->Supply(s2, w2) <= sol->ResidualCapacity(w1) + sol->Supply(s1, w1))
-									{
-										double improvement = (in.SupplyCost(s1, w1) - in.SupplyCost(s1, w2)) * sol->Supply(s1, w1) + (in.SupplyCost(s2, w2) - in.SupplyCost(s2, w1)) * sol->Supply(s2, w2);
+									double improvement = (in.SupplyCost(s1, w1) - in.SupplyCost(s1, w2)) * sol->Supply(s1, w1) + (in.SupplyCost(s2, w2) - in.SupplyCost(s2, w1)) * sol->Supply(s2, w2);
 
-										if (improvement > MY_EPSILON)
-											moves.push({s1, s2, w1, w2, improvement});
+									profile.moves_evaluated++;
+									if (improvement > MY_EPSILON)
+									{
+										moves->push({s1, s2, w1, w2, improvement});
+										profile.moves_pushed++;
 									}
 								}
-						}
+							}
 					}
 				}
+			}
+
+	shared->evaluations_done += profile.moves_evaluated - evaluated;
+}
+
+// Local search using a priority queue of improving moves and multi improvement strategy
+// (moves are first computed for the warehouses in `invalid`, or for all warehouses if it is NULL)
+void WL_MRILS::LocalSearch(WL_Solution *sol, const unordered_set<unsigned> *invalid)
+{
+	profile.descents++;
 
+	unordered_set<unsigned> invalid_warehouses, no_warehouses;
+
+	if (invalid)
+		invalid_warehouses = *invalid;
+	else
+		for (unsigned w = 0; w < in.Warehouses(); w++)
+			invalid_warehouses.insert(w);
+
+	MoveQueue moves;
+
+	while (!Exhausted())
+	{
+		// (Re)compute moves for invalid warehouses
+		WL_Timer generation_timer(profile.move_generation_time);
+		ComputeMoves(sol, invalid_warehouses, no_warehouses, no_warehouses, &moves);
+		generation_timer.Stop();
 		if (moves.empty())
 			break;
 
 		invalid_warehouses.clear();
 
-		while (!moves.empty() && clock() / CLOCKS_PER_SEC < timeout)
+		WL_Timer application_timer(profile.move_application_time);
+		while (!moves.empty() && !Exhausted())
 		{
 			Move move = moves.top();
 			moves.pop();
 
 			if (invalid_warehouses.find(move.w1) != invalid_warehouses.end() || invalid_warehouses.find(move.w2) != invalid_warehouses.end())
+			{
+				profile.moves_stale++;
 				continue;
+			}
 
 			if (move.s2 == in.Stores())
 			{
@@ -507,6 +1117,8 @@ void WL_MRILS::LocalSearch(WL_Solution *sol)
 				sol->Assign(move.s2, move.w1, q);
 			}
 
+			profile.moves_applied++;
+
 			// Invalidate warehouses affected by last move
 			invalid_warehouses.insert(move.w1);
 			invalid_warehouses.insert(move.w2);
@@ -515,11 +1127,15 @@ void WL_MRILS::LocalSearch(WL_Solution *sol)
 }
 
 // ILS using a priority queue of improving moves and multi improvement strategy
-WL_Solution *WL_MRILS::IteratedLocalSearch(WL_Solution *sol)
+// (moves are first computed for the warehouses in `invalid`, or for all warehouses if it is NULL)
+WL_Solution *WL_MRILS::IteratedLocalSearch(WL_Solution *sol, const unordered_set<unsigned> *invalid)
 {
+	WL_Timer ils_timer(profile.ils_time);
+	profile.ils_runs++;
+
 	if (ils_maxiter == 1)
 	{
-		LocalSearch(sol);
+		LocalSearch(sol, invalid);
 		return sol;
 	}
 
@@ -528,13 +1144,17 @@ WL_Solution *WL_MRILS::IteratedLocalSearch(WL_Solution *sol)
 
 	unordered_set<unsigned> invalid_warehouses, closing_forbidden, opening_forbidden;
 
-	for (unsigned w = 0; w < in.Warehouses(); w++)
-		invalid_warehouses.insert(w);
+	if (invalid)
+		invalid_warehouses = *invalid;
+	else
+		for (unsigned w = 0; w < in.Warehouses(); w++)
+			invalid_warehouses.insert(w);
 
-	priority_queue<Move, vector<Move>, MoveComparator> moves;
+	MoveQueue moves;
 
-	for (unsigned i = 0; clock() / CLOCKS_PER_SEC < timeout && i < ils_maxiter; i++)
+	for (unsigned i = 0; !Exhausted() && i < ils_maxiter; i++)
 	{
+		shared->ils_iterations_done++;
 		if (i > 0)
 		{
 			if (sol->Cost() + MY_EPSILON < ils_accept * best_sol->Cost())
@@ -551,114 +1171,40 @@ WL_Solution *WL_MRILS::IteratedLocalSearch(WL_Solution *sol)
 
 			unsigned perturbation = 0;
 			for (unsigned trials = 0; !perturbation && trials < 5; trials++)
+			{
 				perturbation = Perturbation(sol, &invalid_warehouses, &closing_forbidden, &opening_forbidden);
+				if (!perturbation)
+					profile.perturbations_failed++;
+			}
 
 			if (!perturbation)
 				break;
+			profile.perturbations[perturbation - 1]++;
 		}
+		profile.descents++;
 
-		while (clock() / CLOCKS_PER_SEC < timeout)
+		while (!Exhausted())
 		{
 			// (Re)compute moves for invalid warehouses
-
-			for (auto it = invalid_warehouses.begin(); it != invalid_warehouses.end(); ++it)
-			{
-				unsigned w1 = *it;
-				if (sol->Load(w1))
-					for (auto it2 = sol->supplied_stores[w1].begin(); it2 != sol->supplied_stores[w1].end(); ++it2)
-					{
-						unsigned s1 = *it2;
-						for (unsigned w2 = 0; w2 < in.Warehouses(); w2++)
-							if (w1 != w2 && opening_forbidden.find(w2) == opening_forbidden.end())
-							{
-								// Neighborhood 1: solutions that can be obtained from `sol` by relocating the allowed maximum
-								// quantity of goods supplied to a store (s1) from one warehouse (w1) to another (w2)
-								if (!sol->Incompatibilities(w2, s1) && sol->ResidualCapacity(w2))
-								{
-									unsigned q = min(sol->Supply(s1, w1), sol->ResidualCapacity(w2));
-									double improvement = (in.SupplyCost(s1, w1) - in.SupplyCost(s1, w2)) * q;
-									if (!sol->Load(w2))
-										improvement -= in.FixedCost(w2);
-									if (q == sol->Load(w1) && closing_forbidden.find(w1) == closing_forbidden.end())
-										improvement += in.FixedCost(w1);
-
-									if (improvement > MY_EPSILON)
-										moves.push({s1, in.Stores(), w1, w2, improvement});
-								}
-
-								// Neighborhood 2: solutions that can be obtained from `sol` by exchanging one store (s1)
-								// from one warehouse (w1) with another store (s2) from another warehouse (w2)
-								if (sol->Incompatibilities(w2, s1) <= 1)
-									for (auto it3 = sol->supplied_stores[w2].begin(); it3 != sol->supplied_stores[w2].end(); ++it3)
-									{
-										unsigned s2 = *it3;
-										if (s1 != s2 && ((!sol->Incompatibilities(w1, s2) && !sol->Incompatibilities(w2, s1)) || (sol->Incompatibilities(w1, s2) == 1 && in.Incompatible(s1, s2))) && sol->Supply(s1, w1) <= sol->ResidualCapacity(w2) + sol->Supply(s2, w2) && sol->Supply(s2, w2) <= sol->ResidualCapacity(w1) + sol->Supply(s1, w1))
-										{
-											double improvement = (in.SupplyCost(s1, w1) - in.SupplyCost(s1, w2)) * sol->Supply(s1, w1) + (in.SupplyCost(s2, w2) - in.SupplyCost(s2, w1)) * sol->Supply(s2, w2);
-
-											if (improvement > MY_EPSILON)
-												moves.push({s1, s2, w1, w2, improvement});
-										}
-									}
-							}
-					}
-			}
-
-			for (unsigned w1 = 0; w1 < in.Warehouses(); w1++)
-				if (sol->Load(w1))
-					for (auto it = sol->supplied_stores[w1].begin(); it != sol->supplied_stores[w1].end(); ++it)
-					{
-						unsigned s1 = *it;
-						for (auto it2 = invalid_warehouses.begin(); it2 != invalid_warehouses.end(); ++it2)
-						{
-							unsigned w2 = *it2;
-							if (w1 != w2 && opening_forbidden.find(w2) == opening_forbidden.end())
-							{
-								// Neighborhood 1: solutions that can be obtained from `sol` by relocating the allowed maximum
-								// quantity of goods supplied to a store (s1) from one warehouse (w1) to another (w2)
-								if (!sol->Incompatibilities(w2, s1) && sol->ResidualCapacity(w2))
-								{
-									unsigned q = min(sol->Supply(s1, w1), sol->ResidualCapacity(w2));
-									double improvement = (in.SupplyCost(s1, w1) - in.SupplyCost(s1, w2)) * q;
-									if (!sol->Load(w2))
-										improvement -= in.FixedCost(w2);
-									if (q == sol->Load(w1) && closing_forbidden.find(w1) == closing_forbidden.end())
-										improvement += in.FixedCost(w1);
-
-									if (improvement > MY_EPSILON)
-										moves.push({s1, in.Stores(), w1, w2, improvement});
-								}
-
-								// Neighborhood 2: solutions that can be obtained from `sol` by exchanging one store (s1)
-								// from one warehouse (w1) with another store (s2) from another warehouse (w2)
-								if (sol->Incompatibilities(w2, s1) <= 1)
-									for (auto it3 = sol->supplied_stores[w2].begin(); it3 != sol->supplied_stores[w2].end(); ++it3)
-									{
-										unsigned s2 = *it3;
-										if (s1 != s2 && ((!sol->Incompatibilities(w1, s2) && !sol->Incompatibilities(w2, s1)) || (sol->Incompatibilities(w1, s2) == 1 && in.Incompatible(s1, s2))) && sol->Supply(s1, w1) <= sol->ResidualCapacity(w2) + sol->Supply(s2, w2) && sol->Supply(s2, w2) <= sol->ResidualCapacity(w1) + sol->Supply(s1, w1))
-										{
-											double improvement = (in.SupplyCost(s1, w1) - in.SupplyCost(s1, w2)) * sol->Supply(s1, w1) + (in.SupplyCost(s2, w2) - in.SupplyCost(s2, w1)) * sol->Supply(s2, w2);
-
-											if (improvement > MY_EPSILON)
-												moves.push({s1, s2, w1, w2, improvement});
-										}
-									}
-							}
-						}
-					}
-
+			WL_Timer generation_timer(profile.move_generation_time);
+			ComputeMoves(sol, invalid_warehouses, closing_forbidden, opening_forbidden, &moves);
+			generation_timer.Stop();
 			if (moves.empty())
 				break;
 
 			invalid_warehouses.clear();
 
-			while (!moves.empty() && clock() / CLOCKS_PER_SEC < timeout)
+			WL_Timer application_timer(profile.move_application_time);
+			while (!moves.empty() && !Exhausted())
 			{
 				Move move = moves.top();
 				moves.pop();
 
 				if (invalid_warehouses.find(move.w1) != invalid_warehouses.end() || invalid_warehouses.find(move.w2) != invalid_warehouses.end())
+				{
+					profile.moves_stale++;
 					continue;
+				}
 
 				if (move.s2 == in.Stores())
 				{
@@ -677,6 +1223,8 @@ WL_Solution *WL_MRILS::IteratedLocalSearch(WL_Solution *sol)
 					sol->Assign(move.s2, move.w1, q);
 				}
 
+				profile.moves_applied++;
+
 				// Invalidate warehouses affected by last move
 				invalid_warehouses.insert(move.w1);
 				invalid_warehouses.insert(move.w2);
@@ -686,6 +1234,8 @@ WL_Solution *WL_MRILS::IteratedLocalSearch(WL_Solution *sol)
 			{
 				delete best_sol;
 				best_sol = sol->Copy();
+				if (shared->trace_ils)
+					Trace(*best_sol, "ils", current_iteration, current_pattern);
 			}
 		}
 	}
@@ -698,12 +1248,15 @@ WL_Solution *WL_MRILS::IteratedLocalSearch(WL_Solution *sol)
 }
 
 // Solution perturbation
-unsigned WL_MRILS::Perturbation(WL_Solution *sol, unordered_set<unsigned> *invalid_warehouses, unordered_set<unsigned> *closing_forbidden, unordered_set<unsigned> *opening_forbidden)
+unsigned WL_MRILS::Perturbation(WL_Solution *sol, unordered_set<unsigned> *invalid_warehouses, unordered_set<unsigned> *closing_forbidden, unordered_set<unsigned> *opening_forbidden,
+							   unsigned perturbation)
 {
 	closing_forbidden->clear();
 	opening_forbidden->clear();
 
-	unsigned perturbation = 1 + rand() % 5;
+	if (!perturbation)
+		perturbation = 1 + rng.Below(5);
+	WL_Timer timer(profile.perturbation_time[perturbation - 1]);
 
 	switch (perturbation)
 	{
@@ -717,7 +1270,7 @@ unsigned WL_MRILS::Perturbation(WL_Solution *sol, unordered_set<unsigned> *inval
 		if (candidates.empty())
 			return 0;
 
-		unsigned w1 = candidates[rand() % candidates.size()];
+		unsigned w1 = candidates[rng.Below(candidates.size())];
 		unsigned s = *(sol->supplied_stores[w1].begin());
 
 		sol->RevokeAssignment(s, w1, sol->Supply(s, w1));
@@ -736,6 +1289,10 @@ unsigned WL_MRILS::Perturbation(WL_Solution *sol, unordered_set<unsigned> *inval
 						best_w = w2;
 			}
 
+			// No other warehouse can take the rest of the goods: they go back to w1
+			if (best_w == in.Warehouses())
+				best_w = w1;
+
 			sol->Assign(s, best_w, min(sol->ResidualAmount(s), sol->ResidualCapacity(best_w)));
 
 			invalid_warehouses->insert(best_w);
@@ -755,7 +1312,7 @@ unsigned WL_MRILS::Perturbation(WL_Solution *sol, unordered_set<unsigned> *inval
 		if (candidates.empty())
 			return 0;
 
-		unsigned w = candidates[rand() % candidates.size()];
+		unsigned w = candidates[rng.Below(candidates.size())];
 
 		closing_forbidden->insert(w);
 		invalid_warehouses->insert(w);
@@ -772,7 +1329,7 @@ unsigned WL_MRILS::Perturbation(WL_Solution *sol, unordered_set<unsigned> *inval
 		if (candidates.empty())
 			return 0;
 
-		unsigned w1 = candidates[rand() % candidates.size()];
+		unsigned w1 = candidates[rng.Below(candidates.size())];
 
 		candidates.clear();
 		for (unsigned w = 0; w < in.Warehouses(); w++)
@@ -782,7 +1339,7 @@ unsigned WL_MRILS::Perturbation(WL_Solution *sol, unordered_set<unsigned> *inval
 		if (candidates.empty())
 			return 0;
 
-		unsigned w2 = candidates[rand() % candidates.size()];
+		unsigned w2 = candidates[rng.Below(candidates.size())];
 
 		while (!sol->supplied_stores[w1].empty())
 		{
@@ -917,61 +1474,610 @@ unsigned WL_MRILS::Perturbation(WL_Solution *sol, unordered_set<unsigned> *inval
 	return perturbation;
 }
 
+// Inserts `sol` into the elite pool (and its supplies into the miner index, in slot `slot` if given); returns
+// whether it was inserted (solutions of the same cost as an elite one are not)
+bool WL_MRILS::EliteInsert(const WL_Solution& sol, unsigned slot)
+{
+	pair<set<WL_Solution>::iterator, bool> inserted = elite.insert(sol);
+	if (inserted.second && elite_max_size < MINER_MAX_TRANSACTIONS)
+	{
+		vector<pair<unsigned, unsigned>> transaction; // (w * Stores() + s, quantity) of each supply (s,w)
+		const WL_Solution& elite_sol = *inserted.first;
+		for (unsigned w = 0; w < in.Warehouses(); w++)
+			for (auto it = elite_sol.supplied_stores[w].begin(); it != elite_sol.supplied_stores[w].end(); ++it)
+				transaction.push_back(make_pair(w * in.Stores() + *it, elite_sol.Supply(*it, w)));
+		elite_slots[&elite_sol] = elite_index.Insert(transaction, slot);
+	}
+	return inserted.second;
+}
+
+void WL_MRILS::EliteErase(set<WL_Solution>::iterator it)
+{
+	unordered_map<const WL_Solution*, unsigned>::iterator slot = elite_slots.find(&*it);
+	if (slot != elite_slots.end())
+	{
+		elite_index.Remove(slot->second);
+		elite_slots.erase(slot);
+	}
+	elite.erase(it);
+}
+
+void WL_MRILS::EliteClear()
+{
+	elite.clear();
+	elite_index.Clear();
+	elite_slots.clear();
+}
+
+// Mines the patterns of the elite set: the `n_patterns` largest maximal sets of supplies (s,w) present in at
+// least `min_sup` of the elite solutions, each supply with its minimum quantity in the elite or, with support
+// quantities, in the elite solutions that contain the whole pattern (larger quantities, still feasible, as each
+// of those solutions supplies at least them all)
+// (small elite sets are mined from the index maintained by EliteInsert/EliteErase, larger ones with FPmax; as
+// UpdatePool inserts a solution before evicting the worst one, the index needs room for elite_max_size + 1)
 void WL_MRILS::MineElite()
 {
 	if (elite.size() > 1)
 	{
 		unsigned m_sup = max(2, (int)(min_sup * elite.size()));
 
-		vector<vector<unsigned>> min_supply(in.Stores(), vector<unsigned>(in.Warehouses(), INT_MAX));
+		// Items are supplies (s,w), mapped to the index w * Stores() + s
+		vector<vector<unsigned>> itemsets;
+		vector<vector<unsigned>> min_supply;
+		if (elite_max_size < MINER_MAX_TRANSACTIONS)
+			itemsets = elite_index.MineMaximal(m_sup, n_patterns);
+		else
+		{
+			min_supply.assign(in.Stores(), vector<unsigned>(in.Warehouses(), INT_MAX));
+			Dataset *dataset = new Dataset;
+			for (auto it = elite.begin(); it != elite.end(); ++it)
+			{
+				set<int> transaction;
+				for (unsigned w = 0; w < in.Warehouses(); w++)
+					for (auto it2 = it->supplied_stores[w].begin(); it2 != it->supplied_stores[w].end(); ++it2)
+					{
+						unsigned s = *it2;
+						transaction.insert(w * in.Stores() + s);
+						min_supply[s][w] = min(min_supply[s][w], it->Supply(s, w));
+					}
+				dataset->push_back(transaction);
+			}
+
+			FISet *frequentItemsets = fpmax(dataset, m_sup, n_patterns);
+			for (FISet::iterator it = frequentItemsets->begin(); it != frequentItemsets->end(); ++it)
+				itemsets.push_back(vector<unsigned>(it->begin(), it->end()));
+			delete dataset;
+			delete frequentItemsets;
+		}
 
-		Dataset *dataset = new Dataset;
-		for (auto it = elite.begin(); it != elite.end(); ++it)
+		patterns.clear();
+		pattern_stats.clear();
+		for (unsigned i = 0; i < itemsets.size(); i++)
 		{
-			WL_Solution sol = *it;
-			set<int> transaction;
-			for (unsigned w = 0; w < in.Warehouses(); w++)
-				for (auto it2 = sol.supplied_stores[w].begin(); it2 != sol.supplied_stores[w].end(); ++it2)
+			vector<Supply> pattern;
+			for (unsigned j = 0; j < itemsets[i].size(); j++)
+			{
+				unsigned w = itemsets[i][j] / in.Stores();
+				unsigned s = itemsets[i][j] % in.Stores();
+				pattern.push_back({w, s, min_supply.empty() ? elite_index.MinQuantity(itemsets[i][j]) : min_supply[s][w]});
+			}
+
+			vector<unsigned> quantity;
+			double support = EliteSupport(pattern, &quantity);
+			if (support_quantities)
+				for (unsigned j = 0; j < pattern.size(); j++)
 				{
-					unsigned s = *it2;
-					unsigned index = w * in.Stores() + s; // maps 2D matrix cell indices to a vector index
-					transaction.insert(index);
-					min_supply[s][w] = min(min_supply[s][w], sol.Supply(s, w));
+					profile.pattern_goods_gained += quantity[j] - pattern[j].q;
+					pattern[j].q = quantity[j];
 				}
-			dataset->push_back(transaction);
+			patterns.push_back(pattern);
+			pattern_stats.push_back({0, 0, 0, 0, support, false});
 		}
+	}
+}
 
-		FISet *frequentItemsets = fpmax(dataset, m_sup, n_patterns);
+// Rank-weighted support of `pattern` in the elite pool: the sum of 1 / (r + 1) over the elite solutions that
+// contain all its supplies, r being their rank by cost (0: the best); `quantity` receives the minimum quantity
+// of each supply over those solutions
+double WL_MRILS::EliteSupport(const vector<Supply>& pattern, vector<unsigned>* quantity) const
+{
+	if (quantity)
+		quantity->assign(pattern.size(), INT_MAX);
 
-		patterns.clear();
-		for (FISet::iterator it = frequentItemsets->begin(); it != frequentItemsets->end(); ++it)
-		{
-			vector<Supply> pattern;
+	double support = 0;
+	unsigned rank = 0;
+	for (auto it = elite.begin(); it != elite.end(); ++it, rank++)
+	{
+		bool supporting = true;
+		for (unsigned j = 0; supporting && j < pattern.size(); j++)
+			supporting = it->Supply(pattern[j].s, pattern[j].w) > 0;
+		if (!supporting)
+			continue;
+
+		support += 1.0 / (rank + 1);
+		if (quantity)
+			for (unsigned j = 0; j < pattern.size(); j++)
+				(*quantity)[j] = min((*quantity)[j], it->Supply(pattern[j].s, pattern[j].w));
+	}
+	return support;
+}
 
-			for (std::set<int>::iterator it2 = it->begin(); it2 != it->end(); ++it2)
+// Chooses the pattern of the next reduced iteration, drawing from `random` (must be called holding `pool_mutex`)
+// Adaptive scheduling tries every pattern once, in order, and then draws them with weight
+// 1 / ((1 + PATTERN_GAP_SCALE * gap) * mean time), gap being the relative excess of the best cost of their
+// iterations over the best solution, so good patterns and cheap ones are drawn more often
+unsigned WL_MRILS::NextPattern(WL_Random& random)
+{
+	if (pattern_schedule != SCHEDULE_ROUND_ROBIN)
+	{
+		vector<double> weights(patterns.size(), 0);
+		for (unsigned k = 0; k < patterns.size(); k++)
+		{
+			const PatternStats& stats = pattern_stats[k];
+			if (stats.retired)
+				continue;
+			if (pattern_schedule == SCHEDULE_SUPPORT)
+				weights[k] = stats.support;
+			else if (!stats.dispatched)
+			{
+				pattern_stats[k].dispatched++;
+				return k;
+			}
+			else if (stats.runs)
 			{
-				unsigned index = *it2;
+				double gap = best != NULL ? max(0.0, (stats.best_cost - best->Cost()) / best->Cost()) : 0;
+				weights[k] = 1 / ((1 + PATTERN_GAP_SCALE * gap) * max(stats.time / stats.runs, 1e-6));
+			}
+		}
 
-				unsigned w = index / in.Stores();
-				unsigned s = index % in.Stores();
-				unsigned q = min_supply[s][w];
+		WL_Roulette roulette(weights);
+		if (!roulette.Empty())
+		{
+			unsigned k = roulette.Sample(random.Uniform());
+			pattern_stats[k].dispatched++;
+			return k;
+		}
+	}
 
-				pattern.push_back({w, s, q});
-			}
+	// In turn (skipping retired patterns; at least one is active)
+	unsigned k;
+	do
+	{
+		k = p;
+		p = (p + 1) % patterns.size();
+	} while (pattern_stats[k].retired);
+	pattern_stats[k].dispatched++;
+	return k;
+}
 
-			patterns.push_back(pattern);
+// Supplies of `pattern` sorted by warehouse, store and quantity, so that a pattern has one key whatever
+// the order in which it was mined or received from another island
+static vector<Supply> CanonicalPattern(const vector<Supply>& pattern)
+{
+	vector<Supply> canonical(pattern);
+	sort(canonical.begin(), canonical.end(), [](const Supply& a, const Supply& b)
+	{
+		return a.w != b.w ? a.w < b.w : a.s != b.s ? a.s < b.s : a.q < b.q;
+	});
+	return canonical;
+}
+
+static bool SamePattern(const vector<Supply>& a, const vector<Supply>& b)
+{
+	if (a.size() != b.size())
+		return false;
+	for (unsigned i = 0; i < a.size(); i++)
+		if (a[i].w != b[i].w || a[i].s != b[i].s || a[i].q != b[i].q)
+			return false;
+	return true;
+}
+
+// Hash of a canonical pattern
+static size_t PatternHash(const vector<Supply>& canonical)
+{
+	size_t h = canonical.size();
+	for (unsigned i = 0; i < canonical.size(); i++)
+	{
+		h ^= hash<unsigned>()(canonical[i].w) + 0x9e3779b9 + (h << 6) + (h >> 2);
+		h ^= hash<unsigned>()(canonical[i].s) + 0x9e3779b9 + (h << 6) + (h >> 2);
+		h ^= hash<unsigned>()(canonical[i].q) + 0x9e3779b9 + (h << 6) + (h >> 2);
+	}
+	return h;
+}
+
+// Returns the cache entry of `pattern`, building its reduced instance (of `in`) on a miss and evicting the
+// least recently used entries beyond the capacity (must be called holding `pool_mutex`; the entry stays
+// valid until the next call)
+ReducedEntry& WL_MRILS::Reduced(const vector<Supply>& pattern)
+{
+	vector<Supply> canonical = CanonicalPattern(pattern);
+	size_t key = PatternHash(canonical);
+
+	unordered_map<size_t, list<ReducedEntry>::iterator>::iterator it = reduced_index.find(key);
+	if (it != reduced_index.end())
+	{
+		if (SamePattern(it->second->pattern, canonical))
+		{
+			reduced_cache.splice(reduced_cache.begin(), reduced_cache, it->second);
+			profile.reduced_cache_hits++;
+			return reduced_cache.front();
+		}
+		reduced_cache.erase(it->second); // hash collision: the new pattern takes the key
+		reduced_index.erase(it);
+	}
+
+	reduced_cache.push_front({canonical, WL_Instance(in, canonical), vector<Supply>(), 0, false});
+	reduced_index[key] = reduced_cache.begin();
+	profile.reduced_instances_built++;
+
+	unsigned capacity = REDUCED_CACHE_ROUNDS * max(n_patterns, 1u);
+	while (reduced_cache.size() > capacity)
+	{
+		reduced_index.erase(PatternHash(reduced_cache.back().pattern));
+		reduced_cache.pop_back();
+	}
+
+	return reduced_cache.front();
+}
+
+// Records `sol`, a solution of the reduced instance of `pattern`, if it improves on the best one cached for
+// the pattern (must be called holding `pool_mutex`)
+void WL_MRILS::UpdateReduced(const vector<Supply>& pattern, const WL_Solution& sol)
+{
+	vector<Supply> canonical = CanonicalPattern(pattern);
+	unordered_map<size_t, list<ReducedEntry>::iterator>::iterator it = reduced_index.find(PatternHash(canonical));
+	if (it == reduced_index.end() || !SamePattern(it->second->pattern, canonical))
+		return;
+
+	ReducedEntry& entry = *it->second;
+	if (entry.solved && sol.Cost() >= entry.best_cost - MY_EPSILON)
+		return;
+	entry.best.clear();
+	for (unsigned w = 0; w < sol.supplied_stores.size(); w++)
+		for (auto it2 = sol.supplied_stores[w].begin(); it2 != sol.supplied_stores[w].end(); ++it2)
+			entry.best.push_back({w, *it2, sol.Supply(*it2, w)});
+	entry.best_cost = sol.Cost();
+	entry.solved = true;
+}
+
+void WL_MRILS::ClearReduced()
+{
+	reduced_cache.clear();
+	reduced_index.clear();
+}
+
+// Records the cost (after the ILS on the original instance) and the time of a reduced iteration on pattern `p`
+// (unless the patterns were mined again meanwhile); adaptive scheduling retires a pattern whose first
+// PATTERN_TRIAL_RUNS iterations found nothing good enough for the elite pool (must be called holding `pool_mutex`)
+void WL_MRILS::RecordPattern(unsigned p, const vector<Supply>& pattern, double cost, double seconds)
+{
+	if (p >= patterns.size() || !SamePattern(patterns[p], pattern))
+		return;
+
+	PatternStats& stats = pattern_stats[p];
+	if (!stats.runs || cost < stats.best_cost)
+		stats.best_cost = cost;
+	stats.runs++;
+	stats.time += seconds;
+
+	if (pattern_schedule == SCHEDULE_ADAPTIVE && !stats.retired && stats.runs == PATTERN_TRIAL_RUNS && elite.size() == elite_max_size
+		&& stats.best_cost > (--elite.end())->Cost() + MY_EPSILON)
+	{
+		unsigned active = 0;
+		for (unsigned k = 0; k < pattern_stats.size(); k++)
+			if (!pattern_stats[k].retired)
+				active++;
+		if (active > 1)
+		{
+			stats.retired = true;
+			profile.patterns_retired++;
+			WL_INFO("pattern %u retired after %u iterations (best %.2f)", p, stats.runs, stats.best_cost);
 		}
 	}
 }
 
-// Returns a reduced version of instance `in` based on the pattern indexed by `p`
-WL_Instance WL_MRILS::ReducedInstance(unsigned p)
+// Periodic checkpointing of the search state to `file` (every `interval` seconds and at the end of the run)
+void WL_MRILS::SetCheckpoint(string file, double interval)
+{
+	checkpoint_file = file;
+	checkpoint_interval = interval;
+}
+
+// Writes a list of supplies (a sparse solution or a pattern): number of supplies followed by the supplies
+static void WriteSupplies(ostream &os, const vector<Supply> &supplies)
+{
+	unsigned n = supplies.size();
+	os.write((const char *)&n, sizeof(n));
+	os.write((const char *)supplies.data(), n * sizeof(Supply));
+}
+
+static void WriteSolution(ostream &os, const WL_Solution &sol)
+{
+	vector<Supply> supplies;
+	for (unsigned w = 0; w < sol.supplied_stores.size(); w++)
+		for (auto it = sol.supplied_stores[w].begin(); it != sol.supplied_stores[w].end(); ++it)
+			supplies.push_back({w, *it, sol.Supply(*it, w)});
+	WriteSupplies(os, supplies);
+}
+
+// Reads a list of supplies written by WriteSupplies; returns false unless they are
+// valid on instance `in`: at most one supply per pair (s,w), each of 1 to the capacity of w goods, and no store
+// supplied more than its goods
+static bool ReadSupplies(istream &is, const WL_Instance &in, vector<Supply> *supplies)
+{
+	unsigned n = 0;
+	if (!is.read((char *)&n, sizeof(n)) || n > in.Stores() * in.Warehouses())
+		return false;
+	supplies->resize(n);
+	if (!is.read((char *)supplies->data(), n * sizeof(Supply)))
+		return false;
+
+	vector<unsigned> goods(in.Stores(), 0);
+	unordered_set<unsigned> pairs;
+	for (unsigned i = 0; i < n; i++)
+	{
+		const Supply &supply = (*supplies)[i];
+		if (supply.s >= in.Stores() || supply.w >= in.Warehouses() || !supply.q || supply.q > in.Capacity(supply.w)
+			|| (goods[supply.s] += supply.q) > in.AmountOfGoods(supply.s) || !pairs.insert(supply.w * in.Stores() + supply.s).second)
+			return false;
+	}
+	return true;
+}
+
+static WL_Solution *BuildSolution(WL_Instance &in, const vector<Supply> &supplies)
+{
+	WL_Solution *sol = new WL_Solution(in);
+	for (unsigned i = 0; i < supplies.size(); i++)
+		sol->Assign(supplies[i].s, supplies[i].w, supplies[i].q);
+	return sol;
+}
+
+// Reads a random number stream; an all-zero state (never saved, as it only yields zeros) is invalid
+static bool ReadRandom(istream &is, WL_Random *rng)
 {
-	if (p == reduced_instances.size())
+	if (!is.read((char *)&rng->state, sizeof(rng->state)))
+		return false;
+	for (unsigned i = 0; i < 4; i++)
+		if (rng->state.s[i])
+			return true;
+	return false;
+}
+
+static const char CHECKPOINT_MAGIC[8] = {'M', 'R', 'I', 'L', 'S', 'C', 'K', '5'};
+
+// Saves the search state (counters, time, random number streams, best solution, elite pool with the slots of its
+// solutions in the miner index, patterns with their statistics and the cache of reduced instances, in its LRU
+// order) in binary form; the file is replaced atomically, so a preempted run always leaves a complete checkpoint
+// (must be called holding `pool_mutex`, or with no workers running)
+void WL_MRILS::SaveCheckpoint()
+{
+	string temp_file = checkpoint_file + ".tmp";
+	ofstream os(temp_file, ios::binary);
+	if (!os)
 	{
-		WL_Instance reduced_instance(in, patterns[p]);
-		reduced_instances.push_back(reduced_instance);
+		cerr << "Cannot write checkpoint file " << temp_file << endl;
+		return;
 	}
 
-	return reduced_instances[p];
+	unsigned stores = in.Stores(), warehouses = in.Warehouses();
+	double elapsed = Elapsed();
+	unsigned char updated = elite_updated;
+	unsigned long evaluations = evaluations_done, ils_iterations = ils_iterations_done;
+	os.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+	os.write((const char *)&stores, sizeof(stores));
+	os.write((const char *)&warehouses, sizeof(warehouses));
+	os.write((const char *)&elapsed, sizeof(elapsed));
+	os.write((const char *)&time_best, sizeof(time_best));
+	os.write((const char *)&iteration, sizeof(iteration));
+	os.write((const char *)&evaluations, sizeof(evaluations));
+	os.write((const char *)&ils_iterations, sizeof(ils_iterations));
+	os.write((const char *)&nu_iter, sizeof(nu_iter));
+	os.write((const char *)&max_nu_iter, sizeof(max_nu_iter));
+	os.write((const char *)&p, sizeof(p));
+	os.write((const char *)&updated, sizeof(updated));
+
+	unsigned n = worker_rngs.size();
+	os.write((const char *)&rng.state, sizeof(rng.state));
+	os.write((const char *)&n, sizeof(n));
+	for (unsigned t = 0; t < n; t++)
+		os.write((const char *)&worker_rngs[t].state, sizeof(worker_rngs[t].state));
+
+	unsigned has_best = best != NULL;
+	os.write((const char *)&has_best, sizeof(has_best));
+	if (best != NULL)
+		WriteSolution(os, *best);
+
+	n = elite.size();
+	os.write((const char *)&n, sizeof(n));
+	for (auto it = elite.begin(); it != elite.end(); ++it)
+	{
+		unordered_map<const WL_Solution*, unsigned>::const_iterator slot = elite_slots.find(&*it);
+		unsigned index_slot = slot != elite_slots.end() ? slot->second : MINER_MAX_TRANSACTIONS;
+		WriteSolution(os, *it);
+		os.write((const char *)&index_slot, sizeof(index_slot));
+	}
+
+	n = patterns.size();
+	os.write((const char *)&n, sizeof(n));
+	for (unsigned i = 0; i < patterns.size(); i++)
+	{
+		const PatternStats &stats = pattern_stats[i];
+		unsigned char retired = stats.retired;
+		WriteSupplies(os, patterns[i]);
+		os.write((const char *)&stats.dispatched, sizeof(stats.dispatched));
+		os.write((const char *)&stats.runs, sizeof(stats.runs));
+		os.write((const char *)&stats.best_cost, sizeof(stats.best_cost));
+		os.write((const char *)&stats.time, sizeof(stats.time));
+		os.write((const char *)&stats.support, sizeof(stats.support));
+		os.write((const char *)&retired, sizeof(retired));
+	}
+
+	// The reduced instances are built again from their patterns on resume
+	n = reduced_cache.size();
+	os.write((const char *)&n, sizeof(n));
+	for (auto it = reduced_cache.begin(); it != reduced_cache.end(); ++it)
+	{
+		unsigned char solved = it->solved;
+		WriteSupplies(os, it->pattern);
+		os.write((const char *)&solved, sizeof(solved));
+		if (solved)
+		{
+			WriteSupplies(os, it->best);
+			os.write((const char *)&it->best_cost, sizeof(it->best_cost));
+		}
+	}
+
+	os.close();
+	if (!os || rename(temp_file.c_str(), checkpoint_file.c_str()))
+		cerr << "Cannot write checkpoint file " << checkpoint_file << endl;
+}
+
+// Restores the search state saved by SaveCheckpoint, so the next Run() continues the interrupted run
+// (including its elapsed time, which counts towards the timeout); returns false if `file` is not a valid
+// checkpoint for this instance
+bool WL_MRILS::LoadCheckpoint(string file)
+{
+	ifstream is(file, ios::binary);
+	char magic[sizeof(CHECKPOINT_MAGIC)];
+	unsigned stores = 0, warehouses = 0;
+	is.read(magic, sizeof(magic));
+	is.read((char *)&stores, sizeof(stores));
+	is.read((char *)&warehouses, sizeof(warehouses));
+	if (!is || !equal(magic, magic + sizeof(magic), CHECKPOINT_MAGIC) || stores != in.Stores() || warehouses != in.Warehouses())
+		return false;
+
+	// The whole checkpoint is read and checked before any of it replaces the state of the solver
+	double saved_elapsed = 0, saved_time_best = 0;
+	unsigned saved_iteration = 0, saved_nu_iter = 0, saved_max_nu_iter = 0, saved_p = 0;
+	unsigned long evaluations = 0, ils_iterations = 0;
+	unsigned char updated = 0;
+	is.read((char *)&saved_elapsed, sizeof(saved_elapsed));
+	is.read((char *)&saved_time_best, sizeof(saved_time_best));
+	is.read((char *)&saved_iteration, sizeof(saved_iteration));
+	is.read((char *)&evaluations, sizeof(evaluations));
+	is.read((char *)&ils_iterations, sizeof(ils_iterations));
+	is.read((char *)&saved_nu_iter, sizeof(saved_nu_iter));
+	is.read((char *)&saved_max_nu_iter, sizeof(saved_max_nu_iter));
+	is.read((char *)&saved_p, sizeof(saved_p));
+	is.read((char *)&updated, sizeof(updated));
+	if (!is || !(saved_elapsed >= 0) || !(saved_time_best >= 0) || updated > 1)
+		return false;
+
+	// Counts are not trusted for allocations: the vectors grow as their elements are actually read
+	WL_Random saved_rng;
+	vector<WL_Random> saved_worker_rngs;
+	unsigned n = 0;
+	if (!ReadRandom(is, &saved_rng) || !is.read((char *)&n, sizeof(n)))
+		return false;
+	for (unsigned t = 0; t < n; t++)
+	{
+		WL_Random worker_rng;
+		if (!ReadRandom(is, &worker_rng))
+			return false;
+		saved_worker_rngs.push_back(worker_rng);
+	}
+
+	unsigned has_best = 0;
+	vector<Supply> saved_best;
+	if (!is.read((char *)&has_best, sizeof(has_best)) || has_best > 1 || (has_best && !ReadSupplies(is, in, &saved_best)))
+		return false;
+
+	// Elite solutions take their saved slots in the miner index, which must be distinct if it is in use
+	vector<vector<Supply>> saved_elite;
+	vector<unsigned> saved_slots;
+	uint32_t slots_used = 0;
+	if (!is.read((char *)&n, sizeof(n)) || n > elite_max_size)
+		return false;
+	for (unsigned i = 0; i < n; i++)
+	{
+		vector<Supply> supplies;
+		unsigned slot = 0;
+		if (!ReadSupplies(is, in, &supplies) || !is.read((char *)&slot, sizeof(slot)))
+			return false;
+		if (elite_max_size < MINER_MAX_TRANSACTIONS)
+		{
+			if (slot >= MINER_MAX_TRANSACTIONS || (slots_used & (1u << slot)))
+				return false;
+			slots_used |= 1u << slot;
+		}
+		saved_elite.push_back(supplies);
+		saved_slots.push_back(slot);
+	}
+
+	vector<vector<Supply>> saved_patterns;
+	vector<PatternStats> saved_stats;
+	if (!is.read((char *)&n, sizeof(n)))
+		return false;
+	for (unsigned i = 0; i < n; i++)
+	{
+		vector<Supply> pattern;
+		PatternStats stats;
+		unsigned char retired = 0;
+		if (!ReadSupplies(is, in, &pattern))
+			return false;
+		is.read((char *)&stats.dispatched, sizeof(stats.dispatched));
+		is.read((char *)&stats.runs, sizeof(stats.runs));
+		is.read((char *)&stats.best_cost, sizeof(stats.best_cost));
+		is.read((char *)&stats.time, sizeof(stats.time));
+		is.read((char *)&stats.support, sizeof(stats.support));
+		is.read((char *)&retired, sizeof(retired));
+		if (!is || stats.runs > stats.dispatched || !(stats.best_cost >= 0) || !(stats.time >= 0) || !(stats.support >= 0) || retired > 1)
+			return false;
+		stats.retired = retired;
+		saved_patterns.push_back(pattern);
+		saved_stats.push_back(stats);
+	}
+
+	// Cached patterns are canonical and distinct; the best solution of an entry is one of its reduced instance
+	list<ReducedEntry> saved_cache;
+	unordered_set<size_t> keys;
+	if (!is.read((char *)&n, sizeof(n)) || n > REDUCED_CACHE_ROUNDS * max(n_patterns, 1u))
+		return false;
+	for (unsigned i = 0; i < n; i++)
+	{
+		vector<Supply> pattern;
+		unsigned char solved = 0;
+		if (!ReadSupplies(is, in, &pattern) || !SamePattern(pattern, CanonicalPattern(pattern)) || !keys.insert(PatternHash(pattern)).second
+			|| !is.read((char *)&solved, sizeof(solved)) || solved > 1)
+			return false;
+		saved_cache.push_back({pattern, WL_Instance(in, pattern), vector<Supply>(), 0, solved != 0});
+		ReducedEntry &entry = saved_cache.back();
+		if (solved && (!ReadSupplies(is, entry.instance, &entry.best) || !is.read((char *)&entry.best_cost, sizeof(entry.best_cost))
+					   || !(entry.best_cost >= 0)))
+			return false;
+	}
+
+	resumed_elapsed = saved_elapsed;
+	time_best = saved_time_best;
+	iteration = saved_iteration;
+	evaluations_done = evaluations;
+	ils_iterations_done = ils_iterations;
+	nu_iter = saved_nu_iter;
+	max_nu_iter = saved_max_nu_iter;
+	p = saved_p < saved_patterns.size() ? saved_p : 0;
+	elite_updated = updated;
+	rng = saved_rng;
+	worker_rngs = saved_worker_rngs;
+
+	if (best != NULL)
+		delete best;
+	best = has_best ? BuildSolution(in, saved_best) : NULL;
+
+	EliteClear();
+	for (unsigned i = 0; i < saved_elite.size(); i++)
+	{
+		WL_Solution *sol = BuildSolution(in, saved_elite[i]);
+		EliteInsert(*sol, elite_max_size < MINER_MAX_TRANSACTIONS ? saved_slots[i] : MINER_MAX_TRANSACTIONS);
+		delete sol;
+	}
+
+	patterns = saved_patterns;
+	ClearReduced();
+	reduced_cache.swap(saved_cache);
+	for (auto it = reduced_cache.begin(); it != reduced_cache.end(); ++it)
+		reduced_index[PatternHash(it->pattern)] = it;
+	pattern_stats = saved_stats;
+
+	resumed = true;
+	return true;
 }
\ No newline at end of file
@@ -1,39 +1,195 @@
 // Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
 
 
+#ifndef _WL_MRILS
+#define _WL_MRILS
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <ostream>
+#include <queue>
 #include <set>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "WL_Instance.h"
+#include "WL_Island.h"
+#include "WL_Miner.h"
+#include "WL_Profile.h"
+#include "WL_Random.h"
 #include "WL_Solution.h"
+#include "WL_ThreadPool.h"
 
 #define MY_EPSILON 0.00001 // Precision parameter, used to avoid numerical instabilities
+#define REDUCED_CACHE_ROUNDS 3 // the cache of reduced instances holds the patterns of this many minings
+#define PATTERN_TRIAL_RUNS 3 // reduced iterations after which adaptive scheduling decides, once, whether to retire a pattern
+#define PATTERN_GAP_SCALE 100 // adaptive scheduling: a pattern whose best result is 1% above the best solution gets half the weight
+
+// Move structure
+// If store `s2` is out of range, then type I: supply to store `s1` by warehouse `w1` is reassigned to warehouse `w2`
+// 			(the quantity reassigned is the max between the quantity assigned to `w1` and the residual capacity of `w2`)
+// Otherwise, type II: supply to store `s1` by warehouse `w1` is swaped with supply to store `s2` by warehouse `w2` - i.e. {(w1, s1, q1), (w2, s2, q2)} -> {(w1, s2, q2), (w2, s1, q1)}
+struct Move
+{
+	unsigned s1, s2, w1, w2;
+	double improvement;
+};
+
+// Comparator for ordering moves by improvement
+struct MoveComparator
+{
+	bool operator()(Move m1, Move m2)
+	{
+		return m1.improvement < m2.improvement;
+	}
+};
+
+typedef priority_queue<Move, vector<Move>, MoveComparator> MoveQueue;
+
+// Work budget of a run (0: unlimited): outer iterations, move evaluations and ILS iterations
+// With a budget, the run stops when any of its limits is reached (or on timeout) and its time-dependent
+// decisions follow the fraction of the budget used, so a single-threaded run that does not time out is
+// reproducible for a given seed
+struct WL_Budget
+{
+	unsigned long iterations, evaluations, ils_iterations;
+	WL_Budget() : iterations(0), evaluations(0), ils_iterations(0) {}
+};
+
+// Reduced instance of a pattern and the best solution found on it, kept across minings
+struct ReducedEntry
+{
+	vector<Supply> pattern; // sorted by warehouse, store and quantity
+	WL_Instance instance;
+	vector<Supply> best; // assignments of the best reduced solution (if `solved`)
+	double best_cost;
+	bool solved;
+};
+
+// Order of the patterns in the reduced iterations (see NextPattern)
+enum PatternSchedule
+{
+	SCHEDULE_ROUND_ROBIN,	// in turn
+	SCHEDULE_ADAPTIVE,		// untried patterns first, then weighted by the quality and time of their results; useless patterns are retired
+	SCHEDULE_SUPPORT		// weighted by their support among the best elite solutions
+};
+
+// Results of the reduced iterations on a pattern
+struct PatternStats
+{
+	unsigned dispatched, runs; // iterations started and finished
+	double best_cost; // best solution of its iterations (after the ILS on the original instance), if `runs`
+	double time; // seconds spent by its iterations
+	double support; // rank-weighted support in the elite pool (see EliteSupport)
+	bool retired;
+};
 
 // MineReduce-based Multi-Start ILS solver for the WLP
 class WL_MRILS
 {
 public:
-	WL_MRILS(WL_Instance& i, unsigned timeout, unsigned seed, unsigned elite_max_size, double stabi_param, double min_sup, unsigned n_patterns, bool random_opening, unsigned ils_maxiter, double ils_accept);
+	WL_MRILS(WL_Instance& i, double timeout, unsigned seed, unsigned elite_max_size, double stabi_param, double min_sup, unsigned n_patterns, bool random_opening, unsigned ils_maxiter, double ils_accept, unsigned threads = 1);
 	void Run();
+	void SetTimeout(double timeout) { this->timeout = timeout; } // time budget of the next Run() or Reoptimize()
+	void SetBudget(const WL_Budget& budget) { this->budget = budget; } // work budget of the next Run() or Reoptimize()
+	WL_Solution* Reoptimize(const InstanceDelta& delta); // applies `delta` to the instance and repairs the best solution
+	void AddInitialSolution(WL_Solution* sol); // warm start: `sol` (on the same instance) joins the elite pool when the run starts
+	void SetIsland(WL_Island* island, double migration_interval); // exchange elite solutions and patterns with other processes
+	void SetParallelPatterns(bool parallel) { parallel_patterns = parallel; } // with several threads, solve the reduced instances of all patterns concurrently
+	void SetSupportQuantities(bool support) { support_quantities = support; } // mine pattern quantities per supporting subset of the elite
+	void SetPatternSchedule(PatternSchedule schedule) { pattern_schedule = schedule; }
+	void SetImprovementCallback(function<void(const WL_Solution&, double)> callback); // called with each new best solution and its time
+	void SetCheckpoint(string file, double interval); // save the search state periodically
+	bool LoadCheckpoint(string file); // resume: the next Run() continues from the saved state
 	WL_Solution* Best() const { return best; }
 	double TimeBest() const { return time_best; }
+	void SetTrace(ostream* trace, bool ils = false); // convergence trace (CSV)
+	const WL_Profile& Profile() const { return profile; } // counters and timers of the last run (of all workers)
+protected:
+	// Kernels of the search, for benchmarks (see bench/kernels_bench.cpp)
+	void StartClock() { start = chrono::steady_clock::now(); } // the kernels read the elapsed time outside Run()
+	WL_Solution* InitialSolution();
+	void LocalSearch(WL_Solution* sol, const unordered_set<unsigned>* invalid = NULL);
+	void ComputeMoves(const WL_Solution* sol, const unordered_set<unsigned>& invalid_warehouses, const unordered_set<unsigned>& closing_forbidden,
+					  const unordered_set<unsigned>& opening_forbidden, MoveQueue* moves);
+	unsigned Perturbation(WL_Solution* sol, unordered_set<unsigned>* invalid_warehouses, unordered_set<unsigned>* closing_forbidden, unordered_set<unsigned>* opening_forbidden,
+						  unsigned perturbation = 0); // `perturbation` 1-5 forces a type, 0 draws one
+	bool EliteInsert(const WL_Solution& sol, unsigned slot = MINER_MAX_TRANSACTIONS);
+	void MineElite();
+	unsigned EliteSize() const { return elite.size(); }
+	unsigned EliteMaxSize() const { return elite_max_size; }
 private:
 	WL_Instance& in;
 	WL_Solution* best;
 	double time_best;
-	unsigned timeout, seed, elite_max_size, max_nu_iter, n_patterns, ils_maxiter;
+	double timeout;
+	WL_Budget budget;
+	atomic<unsigned long> evaluations_done, ils_iterations_done; // work of the run counted against `budget` (iterations: `iteration`)
+	unsigned seed, elite_max_size, max_nu_iter, n_patterns, ils_maxiter;
 	double min_sup, ils_accept, stabi_param;
 	bool random_opening;
-	set<WL_Solution,bool(*)(WL_Solution,WL_Solution)> elite;
+	set<WL_Solution,bool(*)(const WL_Solution&,const WL_Solution&)> elite;
+	WL_MinerIndex elite_index; // supplies of the elite solutions, kept up to date when elite_max_size < MINER_MAX_TRANSACTIONS
+	unordered_map<const WL_Solution*, unsigned> elite_slots; // slot of each elite solution in `elite_index`
 	vector<vector<Supply>> patterns;
-	vector<WL_Instance> reduced_instances;
-	WL_Solution* InitialSolution();
+	vector<PatternStats> pattern_stats; // of each pattern
+	PatternSchedule pattern_schedule;
+	list<ReducedEntry> reduced_cache; // most recently used first, at most REDUCED_CACHE_ROUNDS * max(n_patterns, 1) entries
+	unordered_map<size_t, list<ReducedEntry>::iterator> reduced_index; // entries by PatternHash of their pattern
+	vector<WL_Solution*> initial_solutions;
+	WL_Random rng; // random number stream of this solver (or worker)
+	vector<WL_Random> worker_rngs; // random number streams of the workers, as of their last completed iteration
+	WL_MRILS* shared; // solver owning the elite pool, patterns and best solution (`this`, unless a worker)
+	unsigned worker_id;
+	unsigned threads; // number of worker threads (1: sequential search on the calling thread)
+	mutex pool_mutex; // guards the elite pool, patterns, reduced instances, best solution and counters below
+	chrono::steady_clock::time_point start;
+	unsigned iteration, nu_iter, p;
+	bool elite_updated;
+	WL_Island* island;
+	double migration_interval, next_migration;
+	bool parallel_patterns; // with several threads, batch search: the patterns are solved all at once (see SearchBatches)
+	bool support_quantities; // pattern quantities from the elite solutions supporting each pattern (see MineElite)
+	string checkpoint_file;
+	function<void(const WL_Solution&, double)> improvement_callback;
+	double checkpoint_interval, next_checkpoint, resumed_elapsed;
+	bool resumed;
+	WL_Profile profile;
+	ostream* trace;
+	bool trace_ils;
+	mutex trace_mutex; // guards `trace`, written by the workers outside `pool_mutex` for ILS improvements
+	unsigned current_iteration;
+	int current_pattern; // pattern of the reduced phase of the current iteration (-1: original instance)
+	WL_MRILS(WL_MRILS& shared, WL_Instance& i, unsigned worker);
+	double Elapsed() const;
+	double Progress() const;
+	bool Exhausted() const;
+	void Work(WL_Instance* instance, unsigned worker);
+	void Search();
+	void SearchBatches();
+	bool StartIteration(bool maintenance = true);
+	void Iterate(int p, const vector<Supply>& pattern);
+	void UpdatePool(WL_Solution* sol, const WL_MRILS* finder = NULL);
+	void Migrate();
+	void SaveCheckpoint();
+	void Trace(const WL_Solution& sol, const char* source, unsigned iteration, int pattern) const;
 	WL_Solution* InitialSolutionGreedyOpening();
 	WL_Solution* InitialSolutionRandomOpening();
-	void LocalSearch(WL_Solution* sol);
-	WL_Solution* IteratedLocalSearch(WL_Solution* sol);
-	unsigned Perturbation(WL_Solution* sol, unordered_set<unsigned>* invalid_warehouses, unordered_set<unsigned>* closing_forbidden, unordered_set<unsigned>* opening_forbidden);
-	void MineElite();
-	WL_Instance ReducedInstance(unsigned p);
-};
\ No newline at end of file
+	bool RepairAssignment(WL_Solution* sol, unsigned s, vector<unsigned>* opened = NULL);
+	WL_Solution* IteratedLocalSearch(WL_Solution* sol, const unordered_set<unsigned>* invalid = NULL);
+	void EliteErase(set<WL_Solution>::iterator it);
+	void EliteClear();
+	double EliteSupport(const vector<Supply>& pattern, vector<unsigned>* quantity = NULL) const;
+	unsigned NextPattern(WL_Random& random);
+	void RecordPattern(unsigned p, const vector<Supply>& pattern, double cost, double seconds);
+	ReducedEntry& Reduced(const vector<Supply>& pattern);
+	void UpdateReduced(const vector<Supply>& pattern, const WL_Solution& sol);
+	void ClearReduced();
+};
+
+#endif
@@ -0,0 +1,195 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include "WL_Miner.h"
+
+// Bit-parallel mining for tiny databases (such as an elite set), given the number of items with each bitmask
+// (`mask_items`). Every maximal frequent itemset is the set I(T) of items contained in all transactions of
+// some subset T of exactly `minsup` transactions, and I(T) is identified by its closure C(T), the set of
+// transactions that contain all of its items (the AND of their masks). Smaller closures give larger
+// itemsets, so the maximal itemsets are those whose closures are minimal. The transforms take O(n 2^n) time
+// for n transactions and the minimality check O(c^2) for the c distinct closures (c <= n choose minsup).
+// Returns the closures of the (`nlargest` largest) maximal itemsets in decreasing order of size
+static vector<uint32_t> MaximalClosures(const vector<unsigned>& mask_items, unsigned n, uint32_t used, unsigned minsup, unsigned nlargest)
+{
+	// closure[T]: AND of the masks of the items contained in all transactions of T (NONE: no item) and
+	// size[T]: number of those items, by superset transforms over the subsets of transactions
+	const uint32_t NONE = 0xFFFFFFFF;
+	const uint32_t subsets = 1u << n;
+	vector<uint32_t> closure(subsets, NONE);
+	vector<unsigned> size(mask_items.begin(), mask_items.begin() + subsets);
+	for (uint32_t M = 0; M < subsets; M++)
+		if (mask_items[M])
+			closure[M] = M;
+	for (unsigned b = 0; b < n; b++)
+		for (uint32_t T = 0; T < subsets; T++)
+			if (!(T & (1u << b)))
+			{
+				closure[T] &= closure[T | (1u << b)];
+				size[T] += size[T | (1u << b)];
+			}
+
+	vector<uint32_t> closures;
+	for (uint32_t T = 0; T < subsets; T++)
+		if ((T & used) == T && (unsigned)__builtin_popcount(T) == minsup && closure[T] != NONE)
+			closures.push_back(closure[T]);
+	sort(closures.begin(), closures.end());
+	closures.erase(unique(closures.begin(), closures.end()), closures.end());
+
+	vector<pair<int, uint32_t>> maximal; // (-size, closure)
+	for (unsigned k = 0; k < closures.size(); k++)
+	{
+		bool minimal = true;
+		for (unsigned k2 = 0; k2 < closures.size() && minimal; k2++)
+			if (k2 != k && (closures[k2] & closures[k]) == closures[k2])
+				minimal = false;
+		if (minimal)
+			maximal.push_back(make_pair(-(int)size[closures[k]], closures[k]));
+	}
+	sort(maximal.begin(), maximal.end());
+	if (nlargest && maximal.size() > nlargest)
+		maximal.resize(nlargest);
+
+	vector<uint32_t> result(maximal.size());
+	for (unsigned k = 0; k < maximal.size(); k++)
+		result[k] = maximal[k].second;
+	return result;
+}
+
+vector<vector<unsigned>> MineMaximal(const vector<MinerItem>& items, unsigned n_transactions, unsigned minsup, unsigned nlargest)
+{
+	vector<vector<unsigned>> itemsets;
+	if (minsup < 1)
+		minsup = 1;
+	if (n_transactions > MINER_MAX_TRANSACTIONS || minsup > n_transactions)
+		return itemsets;
+
+	vector<unsigned> mask_items(1u << n_transactions, 0);
+	for (unsigned i = 0; i < items.size(); i++)
+		mask_items[items[i].transactions]++;
+	vector<uint32_t> closures = MaximalClosures(mask_items, n_transactions, (1u << n_transactions) - 1, minsup, nlargest);
+
+	itemsets.resize(closures.size());
+	for (unsigned i = 0; i < items.size(); i++)
+		for (unsigned k = 0; k < closures.size(); k++)
+			if ((items[i].transactions & closures[k]) == closures[k])
+				itemsets[k].push_back(items[i].item);
+	for (unsigned k = 0; k < itemsets.size(); k++)
+		sort(itemsets[k].begin(), itemsets[k].end());
+	return itemsets;
+}
+
+WL_MinerIndex::WL_MinerIndex()
+	: slot_items(MINER_MAX_TRANSACTIONS), used(0)
+{
+}
+
+// Adds a transaction (with distinct items) in slot `slot` or, by default, in the first free slot (mining only
+// depends on the slots when itemsets tie, so restoring an index takes the same slots); a full index or a used
+// slot is a caller's bug, so it aborts
+unsigned WL_MinerIndex::Insert(const vector<pair<unsigned, unsigned>>& transaction, unsigned slot)
+{
+	if (slot == MINER_MAX_TRANSACTIONS)
+	{
+		if (Transactions() >= MINER_MAX_TRANSACTIONS)
+		{
+			cerr << "WL_MinerIndex: no free slot for a transaction (at most " << MINER_MAX_TRANSACTIONS << ")" << endl;
+			abort();
+		}
+		slot = __builtin_ctz(~used);
+	}
+	else if (slot > MINER_MAX_TRANSACTIONS || (used & (1u << slot)))
+	{
+		cerr << "WL_MinerIndex: slot " << slot << " is not free" << endl;
+		abort();
+	}
+	used |= 1u << slot;
+	if (mask_items.size() < (2u << slot))
+		mask_items.resize(2u << slot, 0); // covers every mask of the slots up to this one
+
+	slot_items[slot].resize(transaction.size());
+	for (unsigned i = 0; i < transaction.size(); i++)
+	{
+		Occurrences& occurrences = items[transaction[i].first]; // new items are value-initialized (no transactions)
+		if (occurrences.transactions)
+			mask_items[occurrences.transactions]--;
+		occurrences.transactions |= 1u << slot;
+		occurrences.quantity[slot] = transaction[i].second;
+		mask_items[occurrences.transactions]++;
+		slot_items[slot][i] = transaction[i].first;
+	}
+	return slot;
+}
+
+void WL_MinerIndex::Remove(unsigned slot)
+{
+	if (slot >= MINER_MAX_TRANSACTIONS || !(used & (1u << slot)))
+		return;
+	used &= ~(1u << slot);
+
+	for (unsigned i = 0; i < slot_items[slot].size(); i++)
+	{
+		unordered_map<unsigned, Occurrences>::iterator it = items.find(slot_items[slot][i]);
+		mask_items[it->second.transactions]--;
+		it->second.transactions &= ~(1u << slot);
+		if (it->second.transactions)
+			mask_items[it->second.transactions]++;
+		else
+			items.erase(it);
+	}
+	slot_items[slot].clear();
+}
+
+void WL_MinerIndex::Clear()
+{
+	for (auto it = items.begin(); it != items.end(); ++it)
+		mask_items[it->second.transactions]--;
+	items.clear();
+	for (unsigned slot = 0; slot < MINER_MAX_TRANSACTIONS; slot++)
+		slot_items[slot].clear();
+	used = 0;
+}
+
+// Mines the transactions of the used slots (free slots below the last used one cost as empty transactions)
+vector<vector<unsigned>> WL_MinerIndex::MineMaximal(unsigned minsup, unsigned nlargest) const
+{
+	vector<vector<unsigned>> itemsets;
+	if (minsup < 1)
+		minsup = 1;
+	if (minsup > Transactions())
+		return itemsets;
+
+	unsigned n = 32 - __builtin_clz(used);
+	vector<uint32_t> closures = MaximalClosures(mask_items, n, used, minsup, nlargest);
+
+	itemsets.resize(closures.size());
+	for (auto it = items.begin(); it != items.end(); ++it)
+		for (unsigned k = 0; k < closures.size(); k++)
+			if ((it->second.transactions & closures[k]) == closures[k])
+				itemsets[k].push_back(it->first);
+	for (unsigned k = 0; k < itemsets.size(); k++)
+		sort(itemsets[k].begin(), itemsets[k].end());
+	return itemsets;
+}
+
+unsigned WL_MinerIndex::MinQuantity(unsigned item) const
+{
+	unordered_map<unsigned, Occurrences>::const_iterator it = items.find(item);
+	if (it == items.end())
+		return 0;
+
+	unsigned quantity = 0;
+	bool first = true;
+	for (uint32_t mask = it->second.transactions; mask; mask &= mask - 1)
+	{
+		unsigned slot = __builtin_ctz(mask);
+		if (first || it->second.quantity[slot] < quantity)
+			quantity = it->second.quantity[slot];
+		first = false;
+	}
+	return quantity;
+}
@@ -0,0 +1,52 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#ifndef _WL_MINER
+#define _WL_MINER
+
+#include <stdint.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+#define MINER_MAX_TRANSACTIONS 16 // largest database of the bitmask miner (its time and memory grow with 2^transactions)
+
+// Item of a small transaction database, with the bitmask of the transactions that contain it
+struct MinerItem
+{
+	unsigned item;
+	uint32_t transactions;
+};
+
+// Maximal frequent itemsets (items in increasing order) of a database of `n_transactions` transactions,
+// in decreasing order of size; if `nlargest` > 0, only the `nlargest` largest ones
+vector<vector<unsigned>> MineMaximal(const vector<MinerItem>& items, unsigned n_transactions, unsigned minsup, unsigned nlargest = 0);
+
+// Transaction database of up to MINER_MAX_TRANSACTIONS transactions of (item, quantity) pairs, updated
+// incrementally: each transaction takes a free slot and each item keeps the bitmask of the slots that
+// contain it, so mining does not rescan the transactions
+class WL_MinerIndex
+{
+public:
+	WL_MinerIndex();
+	unsigned Insert(const vector<pair<unsigned, unsigned>>& transaction, unsigned slot = MINER_MAX_TRANSACTIONS); // default slot: the first free one; returns the slot
+	void Remove(unsigned slot);
+	void Clear();
+	unsigned Transactions() const { return __builtin_popcount(used); }
+	vector<vector<unsigned>> MineMaximal(unsigned minsup, unsigned nlargest = 0) const; // as the function above
+	unsigned MinQuantity(unsigned item) const; // minimum quantity of `item` in the transactions that contain it
+private:
+	struct Occurrences
+	{
+		uint32_t transactions;
+		unsigned quantity[MINER_MAX_TRANSACTIONS];
+	};
+	unordered_map<unsigned, Occurrences> items;
+	vector<vector<unsigned>> slot_items; // items of the transaction in each slot
+	vector<unsigned> mask_items; // number of items with each bitmask (grown with the highest slot used, not allocated up front)
+	uint32_t used; // bitmask of the used slots
+};
+
+#endif
@@ -0,0 +1,90 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#include "WL_Profile.h"
+
+WL_Profile::WL_Profile()
+	: iterations(0), reduced_iterations(0), constructions(0), descents(0), ils_runs(0), moves_evaluated(0), moves_pushed(0),
+	  moves_applied(0), moves_stale(0), perturbations_failed(0), minings(0), patterns_mined(0), pattern_goods_gained(0), patterns_retired(0),
+	  reduced_instances_built(0), reduced_cache_hits(0), reduced_warm_starts(0), construction_time(0), ils_time(0), move_generation_time(0),
+	  move_application_time(0), mining_time(0), reduced_instance_time(0)
+{
+	for (unsigned k = 0; k < PERTURBATIONS; k++)
+	{
+		perturbations[k] = 0;
+		perturbation_time[k] = 0;
+	}
+}
+
+void WL_Profile::Add(const WL_Profile& profile)
+{
+	iterations += profile.iterations;
+	reduced_iterations += profile.reduced_iterations;
+	constructions += profile.constructions;
+	descents += profile.descents;
+	ils_runs += profile.ils_runs;
+	moves_evaluated += profile.moves_evaluated;
+	moves_pushed += profile.moves_pushed;
+	moves_applied += profile.moves_applied;
+	moves_stale += profile.moves_stale;
+	perturbations_failed += profile.perturbations_failed;
+	minings += profile.minings;
+	patterns_mined += profile.patterns_mined;
+	pattern_goods_gained += profile.pattern_goods_gained;
+	patterns_retired += profile.patterns_retired;
+	reduced_instances_built += profile.reduced_instances_built;
+	reduced_cache_hits += profile.reduced_cache_hits;
+	reduced_warm_starts += profile.reduced_warm_starts;
+	construction_time += profile.construction_time;
+	ils_time += profile.ils_time;
+	move_generation_time += profile.move_generation_time;
+	move_application_time += profile.move_application_time;
+	mining_time += profile.mining_time;
+	reduced_instance_time += profile.reduced_instance_time;
+	for (unsigned k = 0; k < PERTURBATIONS; k++)
+	{
+		perturbations[k] += profile.perturbations[k];
+		perturbation_time[k] += profile.perturbation_time[k];
+	}
+}
+
+// Writes the counters and timers as the members of a JSON object (without the braces), one per line
+// prefixed by `indent`; timers are summed over the workers, so they can exceed the wall-clock time
+void WL_Profile::WriteJSON(ostream& os, const char* indent) const
+{
+	os << indent << "\"counters\": {" << endl
+	   << indent << "  \"iterations\": " << iterations << "," << endl
+	   << indent << "  \"reduced_iterations\": " << reduced_iterations << "," << endl
+	   << indent << "  \"constructions\": " << constructions << "," << endl
+	   << indent << "  \"descents\": " << descents << "," << endl
+	   << indent << "  \"ils_runs\": " << ils_runs << "," << endl
+	   << indent << "  \"moves_evaluated\": " << moves_evaluated << "," << endl
+	   << indent << "  \"moves_pushed\": " << moves_pushed << "," << endl
+	   << indent << "  \"moves_applied\": " << moves_applied << "," << endl
+	   << indent << "  \"moves_stale\": " << moves_stale << "," << endl
+	   << indent << "  \"perturbations\": [";
+	for (unsigned k = 0; k < PERTURBATIONS; k++)
+		os << (k ? ", " : "") << perturbations[k];
+	os << "]," << endl
+	   << indent << "  \"perturbations_failed\": " << perturbations_failed << "," << endl
+	   << indent << "  \"minings\": " << minings << "," << endl
+	   << indent << "  \"patterns_mined\": " << patterns_mined << "," << endl
+	   << indent << "  \"pattern_goods_gained\": " << pattern_goods_gained << "," << endl
+	   << indent << "  \"patterns_retired\": " << patterns_retired << "," << endl
+	   << indent << "  \"reduced_instances_built\": " << reduced_instances_built << "," << endl
+	   << indent << "  \"reduced_cache_hits\": " << reduced_cache_hits << "," << endl
+	   << indent << "  \"reduced_warm_starts\": " << reduced_warm_starts << endl
+	   << indent << "}," << endl
+	   << indent << "\"timers\": {" << endl
+	   << indent << "  \"construction\": " << construction_time << "," << endl
+	   << indent << "  \"ils\": " << ils_time << "," << endl
+	   << indent << "  \"move_generation\": " << move_generation_time << "," << endl
+	   << indent << "  \"move_application\": " << move_application_time << "," << endl
+	   << indent << "  \"perturbations\": [";
+	for (unsigned k = 0; k < PERTURBATIONS; k++)
+		os << (k ? ", " : "") << perturbation_time[k];
+	os << "]," << endl
+	   << indent << "  \"mining\": " << mining_time << "," << endl
+	   << indent << "  \"reduced_instance\": " << reduced_instance_time << endl
+	   << indent << "}" << endl;
+}
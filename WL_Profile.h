@@ -0,0 +1,50 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#ifndef _WL_PROFILE
+#define _WL_PROFILE
+
+#include <chrono>
+#include <ostream>
+
+using namespace std;
+
+// Profiling counters and timers of a run (each worker keeps its own, merged into the solver when it finishes)
+struct WL_Profile
+{
+	static const unsigned PERTURBATIONS = 5;
+
+	// counters
+	unsigned long long iterations, reduced_iterations, constructions, descents, ils_runs;
+	unsigned long long moves_evaluated, moves_pushed, moves_applied, moves_stale;
+	unsigned long long perturbations[PERTURBATIONS], perturbations_failed;
+	unsigned long long minings, patterns_mined, pattern_goods_gained, patterns_retired, reduced_instances_built, reduced_cache_hits, reduced_warm_starts;
+
+	// timers (seconds)
+	double construction_time, ils_time, move_generation_time, move_application_time, perturbation_time[PERTURBATIONS];
+	double mining_time, reduced_instance_time;
+
+	WL_Profile();
+	void Add(const WL_Profile& profile);
+	void WriteJSON(ostream& os, const char* indent = "") const;
+};
+
+// Adds the time until Stop() (or the end of its scope) to `seconds`
+class WL_Timer
+{
+public:
+	WL_Timer(double& seconds) : seconds(seconds), running(true), start(chrono::steady_clock::now()) { }
+	~WL_Timer() { Stop(); }
+	void Stop()
+	{
+		if (running)
+			seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		running = false;
+	}
+private:
+	double& seconds;
+	bool running;
+	chrono::steady_clock::time_point start;
+};
+
+#endif
@@ -0,0 +1,119 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#ifndef _WL_RANDOM
+#define _WL_RANDOM
+
+#include <stdint.h>
+
+// Solver-owned pseudo-random number generator (xoshiro256**), usable from both the C and the C++ code
+// Independent streams for the same seed are obtained with jumps of 2^128 steps (stream k = k jumps),
+// so each worker can have its own reproducible sequence
+
+typedef struct
+{
+	uint64_t s[4];
+} wl_rng;
+
+static inline uint64_t wl_rng_rotl(uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t wl_rng_next(wl_rng *rng)
+{
+	uint64_t *s = rng->s;
+	uint64_t result = wl_rng_rotl(s[1] * 5, 7) * 9;
+	uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = wl_rng_rotl(s[3], 45);
+
+	return result;
+}
+
+// Advances the generator by the number of steps encoded in `jump`
+static inline void wl_rng_apply_jump(wl_rng *rng, const uint64_t jump[4])
+{
+	uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+	for (int i = 0; i < 4; i++)
+		for (int b = 0; b < 64; b++)
+		{
+			if (jump[i] & (uint64_t)1 << b)
+			{
+				s0 ^= rng->s[0];
+				s1 ^= rng->s[1];
+				s2 ^= rng->s[2];
+				s3 ^= rng->s[3];
+			}
+			wl_rng_next(rng);
+		}
+
+	rng->s[0] = s0;
+	rng->s[1] = s1;
+	rng->s[2] = s2;
+	rng->s[3] = s3;
+}
+
+// Advances the generator by 2^128 steps
+static inline void wl_rng_jump(wl_rng *rng)
+{
+	static const uint64_t JUMP[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+	wl_rng_apply_jump(rng, JUMP);
+}
+
+// Advances the generator by 2^192 steps (past any stream of wl_rng_seed, which starts 2^128 steps per stream)
+static inline void wl_rng_long_jump(wl_rng *rng)
+{
+	static const uint64_t LONG_JUMP[] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635};
+	wl_rng_apply_jump(rng, LONG_JUMP);
+}
+
+// Initializes stream `stream` of seed `seed` (state filled by splitmix64, as recommended for xoshiro)
+static inline void wl_rng_seed(wl_rng *rng, uint64_t seed, unsigned stream)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		uint64_t z = (seed += 0x9e3779b97f4a7c15);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+		rng->s[i] = z ^ (z >> 31);
+	}
+
+	for (unsigned k = 0; k < stream; k++)
+		wl_rng_jump(rng);
+}
+
+// Uniform integer in [0, n) (n > 0), by multiply-shift of the upper 32 bits
+static inline unsigned wl_rng_below(wl_rng *rng, unsigned n)
+{
+	return (unsigned)(((wl_rng_next(rng) >> 32) * (uint64_t)n) >> 32);
+}
+
+// Uniform real in [0, 1)
+static inline double wl_rng_uniform(wl_rng *rng)
+{
+	return (wl_rng_next(rng) >> 11) * (1.0 / 9007199254740992.0); // 53 random bits
+}
+
+#ifdef __cplusplus
+
+// C++ interface
+class WL_Random
+{
+public:
+	WL_Random(uint64_t seed = 0, unsigned stream = 0) { Seed(seed, stream); }
+	void Seed(uint64_t seed, unsigned stream = 0) { wl_rng_seed(&state, seed, stream); }
+	unsigned Below(unsigned n) { return wl_rng_below(&state, n); }
+	double Uniform() { return wl_rng_uniform(&state); }
+	wl_rng state;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,50 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#include "WL_Roulette.h"
+
+// Creates a roulette wheel with the given (non-negative) selection weights
+WL_Roulette::WL_Roulette(const vector<double>& weights)
+	: size(weights.size()), leaves(1)
+{
+	while (leaves < size)
+		leaves *= 2;
+
+	tree.resize(2 * leaves, 0);
+	for (unsigned i = 0; i < size; i++)
+		tree[leaves + i] = weights[i];
+	for (unsigned k = leaves - 1; k > 0; k--)
+		tree[k] = tree[2 * k] + tree[2 * k + 1];
+}
+
+// Returns the item whose cumulative weight interval contains `random` * TotalWeight()
+// Subtrees with no weight left are never entered, so removed items are never returned
+unsigned WL_Roulette::Sample(double random) const
+{
+	double target = random * tree[1];
+	unsigned k = 1;
+
+	while (k < leaves)
+	{
+		unsigned left = 2 * k;
+		if (tree[left + 1] <= 0 || (target < tree[left] && tree[left] > 0))
+			k = left;
+		else
+		{
+			target -= tree[left];
+			k = left + 1;
+		}
+	}
+
+	return k - leaves;
+}
+
+// Sets the weight of item `i` and updates the sums on its path to the root
+// (sums are recomputed from the children, so removals do not accumulate rounding errors)
+void WL_Roulette::Update(unsigned i, double weight)
+{
+	unsigned k = leaves + i;
+	tree[k] = weight;
+	for (k /= 2; k > 0; k /= 2)
+		tree[k] = tree[2 * k] + tree[2 * k + 1];
+}
@@ -0,0 +1,29 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#ifndef _WL_ROULETTE
+#define _WL_ROULETTE
+
+#include <vector>
+
+using namespace std;
+
+// Roulette wheel over items 0..n-1 with O(log n) sampling and removal
+// (segment tree of selection weights: leaves hold item weights, inner nodes hold subtree sums)
+class WL_Roulette
+{
+public:
+	WL_Roulette(const vector<double>& weights);
+	unsigned Size() const { return size; }
+	double Weight(unsigned i) const { return tree[leaves + i]; }
+	double TotalWeight() const { return tree[1]; }
+	bool Empty() const { return tree[1] <= 0; } // no item left with positive weight
+	unsigned Sample(double random) const; // item selected by `random` in [0, 1], with probability proportional to its weight
+	void Update(unsigned i, double weight); // sets the weight of item `i`
+	void Remove(unsigned i) { Update(i, 0); }
+private:
+	unsigned size, leaves;
+	vector<double> tree; // tree[1] is the root, children of node k are 2k and 2k+1, leaf of item i is leaves+i
+};
+
+#endif
@@ -0,0 +1,327 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "WL_Server.h"
+#include "WL_Solver.h"
+
+// Buffered reading of lines and payloads from a connection
+class WL_Connection
+{
+public:
+	WL_Connection(int fd) : fd(fd) { }
+	bool ReadLine(string* line);
+	bool Read(size_t bytes, string* data);
+	bool Write(const string& data);
+private:
+	int fd;
+	string buffer;
+	bool Fill();
+};
+
+bool WL_Connection::Fill()
+{
+	char chunk[4096];
+	ssize_t n = read(fd, chunk, sizeof(chunk));
+	if (n <= 0)
+		return false;
+	buffer.append(chunk, n);
+	return true;
+}
+
+// Reads a line (without the end of line)
+bool WL_Connection::ReadLine(string* line)
+{
+	size_t end;
+	while ((end = buffer.find('\n')) == string::npos)
+		if (buffer.size() > SERVER_MAX_PAYLOAD || !Fill())
+			return false;
+
+	*line = buffer.substr(0, end);
+	if (!line->empty() && line->back() == '\r')
+		line->pop_back();
+	buffer.erase(0, end + 1);
+	return true;
+}
+
+bool WL_Connection::Read(size_t bytes, string* data)
+{
+	while (buffer.size() < bytes)
+		if (!Fill())
+			return false;
+
+	*data = buffer.substr(0, bytes);
+	buffer.erase(0, bytes);
+	return true;
+}
+
+bool WL_Connection::Write(const string& data)
+{
+	for (size_t sent = 0; sent < data.size(); )
+	{
+		ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL); // a closed client must not kill the server
+		if (n <= 0)
+			return false;
+		sent += n;
+	}
+	return true;
+}
+
+WL_Server::WL_Server(string socket_file, unsigned threads)
+	: socket_file(socket_file), threads(threads)
+{
+	sockaddr_un address = sockaddr_un();
+	address.sun_family = AF_UNIX;
+	if (socket_file.size() >= sizeof(address.sun_path))
+	{
+		cerr << "Socket file name too long: " << socket_file << endl;
+		exit(1);
+	}
+	socket_file.copy(address.sun_path, socket_file.size());
+
+	// Only a stale socket is replaced, never another kind of file
+	struct stat status;
+	if (lstat(socket_file.c_str(), &status) == 0)
+	{
+		if (!S_ISSOCK(status.st_mode))
+		{
+			cerr << "Socket file " << socket_file << " exists and is not a socket" << endl;
+			exit(1);
+		}
+		unlink(socket_file.c_str());
+	}
+
+	listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listen_fd < 0 || bind(listen_fd, (sockaddr*)&address, sizeof(address)) < 0 || listen(listen_fd, 16) < 0)
+	{
+		cerr << "Cannot listen on socket file " << socket_file << endl;
+		exit(1);
+	}
+}
+
+WL_Server::~WL_Server()
+{
+	close(listen_fd);
+	unlink(socket_file.c_str());
+	while (!instances.empty())
+		Drop(instances.begin()->first);
+}
+
+void WL_Server::Serve()
+{
+	bool running = true;
+	while (running)
+	{
+		int fd = accept(listen_fd, NULL, NULL);
+		if (fd < 0)
+			continue;
+
+		WL_Connection connection(fd);
+		string request, reply;
+		while (running && connection.ReadLine(&request))
+		{
+			if (request.empty())
+				continue;
+
+			istringstream is(request);
+			string command, name;
+			size_t bytes = 0, changes = 0;
+			is >> command;
+
+			// Read the payload of the request, if any
+			string payload;
+			bool complete = true;
+			if (command == "INSTANCE" && is >> name >> bytes)
+			{
+				// An oversized payload is neither allocated nor read: the connection is closed after the reply
+				if (bytes > SERVER_MAX_PAYLOAD)
+				{
+					connection.Write("ERROR payload too large\n");
+					break;
+				}
+				complete = connection.Read(bytes, &payload);
+			}
+			else if (command == "DELTA" && is >> name >> changes)
+				for (size_t i = 0; complete && i < changes; i++)
+				{
+					string change;
+					complete = connection.ReadLine(&change) && payload.size() + change.size() < SERVER_MAX_PAYLOAD;
+					payload += change + "\n";
+				}
+			if (!complete)
+				break;
+
+			running = Handle(request + "\n" + payload, &reply);
+			if (!connection.Write(reply))
+				break;
+		}
+		close(fd);
+	}
+}
+
+void WL_Server::Cache(string name, WL_Instance* in)
+{
+	Drop(name);
+
+	// The time budget is set by each request
+	SolverOptions options = SolverOptions::ForInstance(*in, 0, 1);
+	WL_MRILS* solver = new WL_MRILS(*in, options.timeout, options.seed, options.elite_size, options.stabi_param, options.min_sup,
+									options.max_patterns, options.random_opening, options.ils_maxiter, options.ils_accept, threads);
+	instances[name] = {in, solver};
+}
+
+void WL_Server::Drop(string name)
+{
+	map<string, CachedInstance>::iterator it = instances.find(name);
+	if (it == instances.end())
+		return;
+
+	if (it->second.solver->Best() != NULL)
+		delete it->second.solver->Best();
+	delete it->second.solver;
+	delete it->second.in;
+	instances.erase(it);
+}
+
+// Reads a change of a DELTA request; returns false if it is malformed
+static bool ReadChange(istream& is, const WL_Instance& in, InstanceDelta* delta)
+{
+	string field;
+	unsigned i = 0, j = 0, value = 0;
+	double cost = 0;
+	is >> field;
+	if (field == "capacity" && is >> i >> value && i >= 1 && i <= in.Warehouses())
+		delta->capacities.push_back(make_pair(i - 1, value));
+	else if (field == "fixed_cost" && is >> i >> value && i >= 1 && i <= in.Warehouses())
+		delta->fixed_costs.push_back(make_pair(i - 1, value));
+	else if (field == "goods" && is >> i >> value && i >= 1 && i <= in.Stores())
+		delta->goods.push_back(make_pair(i - 1, value));
+	else if (field == "supply_cost" && is >> i >> j >> cost && i >= 1 && i <= in.Stores() && j >= 1 && j <= in.Warehouses())
+		delta->supply_costs.push_back({i - 1, j - 1, cost});
+	else if ((field == "incompatible" || field == "compatible") && is >> i >> j && i >= 1 && i <= in.Stores() && j >= 1 && j <= in.Stores())
+		(field == "incompatible" ? delta->added_incompatibilities : delta->removed_incompatibilities).push_back(make_pair(i - 1, j - 1));
+	else
+		return false;
+	return true;
+}
+
+bool WL_Server::Handle(const string& request, string* reply)
+{
+	istringstream is(request);
+	ostringstream os;
+	string command, name;
+	is >> command;
+
+	if (command == "SHUTDOWN")
+	{
+		*reply = "OK\n";
+		return false;
+	}
+
+	if (!(is >> name))
+	{
+		*reply = "ERROR invalid request\n";
+		return true;
+	}
+	map<string, CachedInstance>::iterator it = instances.find(name);
+
+	if (command == "LOAD" || command == "INSTANCE")
+	{
+		WL_Instance* in = NULL;
+		if (command == "LOAD")
+		{
+			string file_name;
+			is >> file_name;
+			ifstream file(file_name);
+			if (file)
+				in = WL_Instance::Parse(file);
+		}
+		else
+		{
+			// The payload follows the request line; parse exactly <bytes> of it
+			size_t bytes;
+			if (is >> bytes && bytes <= SERVER_MAX_PAYLOAD && is.ignore(1))
+			{
+				string data(bytes, '\0');
+				if (is.read(&data[0], bytes))
+				{
+					istringstream payload(data);
+					in = WL_Instance::Parse(payload);
+				}
+			}
+		}
+
+		if (in == NULL)
+			os << "ERROR cannot read instance" << endl;
+		else
+		{
+			Cache(name, in);
+			os << "OK " << in->Warehouses() << " " << in->Stores() << endl;
+		}
+	}
+	else if (it == instances.end())
+		os << "ERROR unknown instance " << name << endl;
+	else if (command == "DROP")
+	{
+		Drop(name);
+		os << "OK" << endl;
+	}
+	else if (command == "DELTA")
+	{
+		size_t changes;
+		double timeout;
+		InstanceDelta delta;
+		bool valid = (bool)(is >> changes >> timeout);
+		is.ignore(numeric_limits<streamsize>::max(), '\n');
+		for (size_t i = 0; valid && i < changes; i++)
+		{
+			string line;
+			getline(is, line);
+			istringstream change(line);
+			valid = ReadChange(change, *it->second.in, &delta);
+		}
+
+		if (!valid)
+			os << "ERROR invalid delta" << endl;
+		else
+		{
+			it->second.solver->SetTimeout(timeout);
+			WL_Solution* sol = it->second.solver->Reoptimize(delta);
+			os << "OK " << setprecision(2) << fixed << sol->Cost() << " " << sol->ComputeViolations() << endl;
+		}
+	}
+	else if (command == "SOLVE")
+	{
+		double timeout;
+		if (!(is >> timeout))
+			os << "ERROR invalid time budget" << endl;
+		else
+		{
+			it->second.solver->SetTimeout(timeout);
+			it->second.solver->Run();
+			WL_Solution* sol = it->second.solver->Best();
+			if (sol == NULL)
+				os << "ERROR no solution found" << endl;
+			else
+			{
+				os << "OK " << setprecision(2) << fixed << sol->Cost() << " " << sol->ComputeViolations() << " "
+				   << setprecision(1) << it->second.solver->TimeBest() << endl;
+				sol->Print(os);
+			}
+		}
+	}
+	else
+		os << "ERROR unknown command " << command << endl;
+
+	*reply = os.str();
+	return true;
+}
@@ -0,0 +1,51 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#ifndef _WL_SERVER
+#define _WL_SERVER
+
+#include <map>
+#include <string>
+
+#include "WL_Instance.h"
+#include "WL_MRILS.h"
+
+#define SERVER_MAX_PAYLOAD (1u << 30) // largest INSTANCE upload, and longest request line or DELTA, in bytes
+
+// Local solver daemon: serves requests over a Unix domain socket, one connection at a time, keeping the
+// instances and their solvers (best solution, for warm starts and re-optimization) between requests
+// Line protocol (indices are 1-based, as in the .dzn and solution files; replies are "OK ..." or "ERROR <message>"):
+//   LOAD <name> <file>                  reads a .dzn file                      -> OK <warehouses> <stores>
+//   INSTANCE <name> <bytes>             followed by <bytes> of .dzn data       -> OK <warehouses> <stores>
+//                                       (above SERVER_MAX_PAYLOAD: ERROR payload too large, and the connection is closed)
+//   DELTA <name> <changes> <timeout>    followed by <changes> lines, each one of
+//                                       capacity <w> <c> | fixed_cost <w> <c> | goods <s> <g> |
+//                                       supply_cost <s> <w> <c> | incompatible <s1> <s2> | compatible <s1> <s2>
+//                                       applies them and repairs the best solution -> OK <cost> <violations>
+//   SOLVE <name> <timeout>              runs the solver, warm started from the best solution
+//                                       -> OK <cost> <violations> <time_to_best>, then the solution line
+//   DROP <name>                         forgets the instance                   -> OK
+//   SHUTDOWN                            stops the server                       -> OK
+class WL_Server
+{
+public:
+	WL_Server(string socket_file, unsigned threads);
+	~WL_Server();
+	void Serve(); // returns after SHUTDOWN
+private:
+	struct CachedInstance
+	{
+		WL_Instance* in;
+		WL_MRILS* solver;
+	};
+
+	string socket_file;
+	int listen_fd;
+	unsigned threads;
+	map<string, CachedInstance> instances;
+	bool Handle(const string& request, string* reply); // returns false on SHUTDOWN
+	void Cache(string name, WL_Instance* in);
+	void Drop(string name);
+};
+
+#endif
@@ -1,6 +1,7 @@
 // Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
 
 
+#include <fstream>
 #include <iostream>
 
 #include "WL_Solution.h"
@@ -14,6 +15,22 @@ WL_Solution::WL_Solution(WL_Instance& my_in)
 	supplied_stores.resize(in.Warehouses());
 }
 
+// Reads a solution from file (see Read)
+WL_Solution::WL_Solution(WL_Instance& my_in, string file_name)
+	: WL_Solution(my_in)
+{
+	ifstream is(file_name);
+	if(!is)
+	{
+		cerr << "Cannot open solution file " << file_name << endl;
+		exit(1);
+	}
+
+	Read(is);
+
+	is.close();
+}
+
 // Creates a solution based on data from another solution `sol`
 WL_Solution::WL_Solution(WL_Solution* sol)
 	: supplied_stores(sol->supplied_stores), in(sol->in), 
@@ -21,6 +38,16 @@ WL_Solution::WL_Solution(WL_Solution* sol)
 		assigned_goods(sol->assigned_goods), load(sol->load), 
 		incompatibilities(sol->incompatibilities)
 {
+}
+
+// Creates a solution based on data from another solution `sol`, bound to instance `my_in`
+// (an instance with the same data as the one of `sol`)
+WL_Solution::WL_Solution(WL_Solution* sol, WL_Instance& my_in)
+	: supplied_stores(sol->supplied_stores), in(my_in), 
+		supply_cost(sol->supply_cost), opening_cost(sol->opening_cost), supply(sol->supply),
+		assigned_goods(sol->assigned_goods), load(sol->load), 
+		incompatibilities(sol->incompatibilities)
+{
 }
 
  // Assigns `q` goods of store `s` to warehouse `w`
@@ -163,6 +190,46 @@ void WL_Solution::Print(ostream& os) const
 	os << "}" << endl;
 }
 
+// Adds the assignments read from `is`, in the format written by Print: {(s,w,q), ...} with 1-based
+// store and warehouse indices (anything after the closing brace, such as the TimeToBest line, is ignored)
+void WL_Solution::Read(istream& is)
+{
+	unsigned s, w, q;
+	char ch, sep1, sep2;
+
+	if (!(is >> ch) || ch != '{')
+	{
+		cerr << "Invalid solution: expected '{'" << endl;
+		exit(1);
+	}
+
+	if (!(is >> ch))
+		ch = 0;
+	while (ch == '(')
+	{
+		if (!(is >> s >> sep1 >> w >> sep2 >> q >> ch) || sep1 != ',' || sep2 != ',' || ch != ')'
+			|| s < 1 || s > in.Stores() || w < 1 || w > in.Warehouses())
+		{
+			cerr << "Invalid solution: bad assignment" << endl;
+			exit(1);
+		}
+
+		if (q > 0)
+			Assign(s - 1, w - 1, q);
+
+		if (!(is >> ch)) // ',' or '}'
+			ch = 0;
+		else if (ch == ',' && !(is >> ch))
+			ch = 0;
+	}
+
+	if (ch != '}')
+	{
+		cerr << "Invalid solution: expected '}'" << endl;
+		exit(1);
+	}
+}
+
 // Returns a copy of this solution
 WL_Solution*  WL_Solution::Copy()
 {
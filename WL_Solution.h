@@ -4,6 +4,7 @@
 #ifndef _WL_SOLUTION
 #define _WL_SOLUTION
 
+#include <iostream>
 #include <unordered_set>
 #include <vector>
 
@@ -14,7 +15,9 @@ class WL_Solution
 {
 public:
 	WL_Solution(WL_Instance& i);
+	WL_Solution(WL_Instance& i, string file_name);
 	WL_Solution(WL_Solution* sol);
+	WL_Solution(WL_Solution* sol, WL_Instance& i);
 	unsigned Supply(unsigned s, unsigned w) const { return supply[s][w]; }
 	unsigned Load(unsigned w) const { return load[w]; }
 	unsigned ResidualCapacity(unsigned w) const { return in.Capacity(w) - load[w]; }
@@ -30,6 +33,7 @@ public:
 	void PrintCosts(ostream& os) const;
 	void PrintViolations(ostream& os) const;
 	void Print(ostream& os) const;
+	void Read(istream& is); // reads assignments in the format written by Print
 	WL_Solution* Copy();	// returns a copy of this solution
 	vector<unordered_set<unsigned>> supplied_stores; //	set of supplied stores for each warehouse (for faster access)
 private:
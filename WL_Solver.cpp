@@ -0,0 +1,113 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#include "WL_MRILS.h"
+#include "WL_Solver.h"
+
+// Parameter settings tuned for each range of the number of warehouses
+SolverOptions SolverOptions::ForInstance(const WL_Instance& in, double timeout, unsigned seed)
+{
+	SolverOptions options;
+	options.timeout = timeout;
+	options.seed = seed;
+	options.threads = 1;
+	options.parallel_patterns = false;
+	options.support_quantities = false;
+	options.pattern_schedule = SCHEDULE_ROUND_ROBIN;
+	options.max_iterations = 0;
+	options.max_evaluations = 0;
+	options.max_ils_iterations = 0;
+
+	if (in.Warehouses() <= 150)
+	{
+		options.random_opening = true;
+		options.ils_maxiter = 100;
+		options.ils_accept = 1.01;
+
+		options.elite_size = 5;
+		options.max_patterns = 10;
+		options.min_sup = 0.4;
+		options.stabi_param = 0.07;
+	}
+	else if (in.Warehouses() <= 600)
+	{
+		options.random_opening = false;
+		options.ils_maxiter = 200;
+		options.ils_accept = 1.01;
+
+		options.elite_size = 10;
+		options.max_patterns = 6;
+		options.min_sup = 0.9;
+		options.stabi_param = 0.03;
+	}
+	else if (in.Warehouses() <= 1400)
+	{
+		options.random_opening = false;
+		options.ils_maxiter = 100;
+		options.ils_accept = 1.05;
+
+		options.elite_size = 5;
+		options.max_patterns = 6;
+		options.min_sup = 0.8;
+		options.stabi_param = 0.04;
+	}
+	else if (in.Warehouses() <= 2000)
+	{
+		options.random_opening = false;
+		options.ils_maxiter = 100;
+		options.ils_accept = 1.05;
+
+		options.elite_size = 5;
+		options.max_patterns = 6;
+		options.min_sup = 0.8;
+		options.stabi_param = 0.03;
+	}
+	else
+	{
+		options.random_opening = false;
+		options.ils_maxiter = 200;
+		options.ils_accept = 1.02;
+
+		options.elite_size = 5;
+		options.max_patterns = 1;
+		options.min_sup = 1.0;
+		options.stabi_param = 0.04;
+	}
+
+	return options;
+}
+
+SolverResult Solve(WL_Instance& in, const SolverOptions& options, const vector<WL_Solution*>& warm_starts)
+{
+	WL_MRILS solver(in, options.timeout, options.seed, options.elite_size, options.stabi_param, options.min_sup, options.max_patterns,
+					options.random_opening, options.ils_maxiter, options.ils_accept, options.threads);
+	WL_Budget budget;
+	budget.iterations = options.max_iterations;
+	budget.evaluations = options.max_evaluations;
+	budget.ils_iterations = options.max_ils_iterations;
+	solver.SetBudget(budget);
+	solver.SetParallelPatterns(options.parallel_patterns);
+	solver.SetSupportQuantities(options.support_quantities);
+	solver.SetPatternSchedule((PatternSchedule)options.pattern_schedule);
+	for (unsigned j = 0; j < warm_starts.size(); j++)
+		solver.AddInitialSolution(warm_starts[j]);
+	solver.Run();
+
+	WL_Solution* sol = solver.Best();
+	SolverResult result;
+	result.found = sol != NULL;
+	result.time_best = solver.TimeBest();
+	if (sol == NULL)
+		return result;
+
+	for (unsigned w = 0; w < in.Warehouses(); w++)
+		for (auto it = sol->supplied_stores[w].begin(); it != sol->supplied_stores[w].end(); ++it)
+			result.supplies.push_back({w, *it, sol->Supply(*it, w)});
+	result.cost = sol->Cost();
+	result.supply_cost = sol->SupplyCost();
+	result.opening_cost = sol->OpeningCost();
+	result.violations = sol->ComputeViolations();
+
+	delete sol;
+	return result;
+}
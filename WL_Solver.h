@@ -0,0 +1,47 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#ifndef _WL_SOLVER
+#define _WL_SOLVER
+
+#include <vector>
+
+#include "WL_Instance.h"
+#include "WL_Solution.h"
+
+// Parameters of the solver (see WL_MRILS)
+struct SolverOptions
+{
+	double timeout;	// seconds
+	unsigned seed;
+	unsigned threads;
+	bool parallel_patterns; // with several threads, solve the reduced instances of all patterns at once
+	bool support_quantities; // pattern quantities from the elite solutions containing each pattern
+	unsigned pattern_schedule; // PatternSchedule (WL_MRILS.h)
+	bool random_opening;
+	unsigned ils_maxiter;
+	double ils_accept;
+	unsigned elite_size;
+	unsigned max_patterns;
+	double min_sup;
+	double stabi_param;
+	unsigned long max_iterations, max_evaluations, max_ils_iterations; // work budget (0: unlimited, see WL_Budget)
+
+	static SolverOptions ForInstance(const WL_Instance& in, double timeout, unsigned seed); // tuned by instance size
+};
+
+// Best solution found by the solver (0-based indices in `supplies`)
+struct SolverResult
+{
+	bool found; // false if the time ran out before any solution was built
+	vector<Supply> supplies;
+	double cost, supply_cost;
+	unsigned opening_cost;
+	unsigned violations;
+	double time_best;
+};
+
+// Solves `in` in-process, starting from the (optional) solutions in `warm_starts`
+SolverResult Solve(WL_Instance& in, const SolverOptions& options, const vector<WL_Solution*>& warm_starts = vector<WL_Solution*>());
+
+#endif
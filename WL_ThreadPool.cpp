@@ -0,0 +1,98 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#include "WL_ThreadPool.h"
+
+WL_ThreadPool::WL_ThreadPool(unsigned threads)
+	: queues(max(threads, 1u)), pending(0), queued(0), next_queue(0), stopping(false)
+{
+	for (unsigned t = 0; t < queues.size(); t++)
+		workers.push_back(thread(&WL_ThreadPool::Work, this, t));
+}
+
+// Finishes the queued tasks and joins the threads
+WL_ThreadPool::~WL_ThreadPool()
+{
+	{
+		lock_guard<mutex> lock(state_mutex);
+		stopping = true;
+	}
+	work_available.notify_all();
+	for (unsigned t = 0; t < workers.size(); t++)
+		workers[t].join();
+}
+
+void WL_ThreadPool::Submit(function<void()> task)
+{
+	unsigned q;
+	{
+		lock_guard<mutex> lock(state_mutex);
+		pending++;
+		queued++; // a thread woken before the push below retries until it finds the task
+		q = next_queue;
+		next_queue = (next_queue + 1) % queues.size();
+	}
+	{
+		lock_guard<mutex> lock(queues[q].queue_mutex);
+		queues[q].tasks.push_back(task);
+	}
+	work_available.notify_one();
+}
+
+void WL_ThreadPool::Wait()
+{
+	unique_lock<mutex> lock(state_mutex);
+	all_done.wait(lock, [this] { return pending == 0; });
+}
+
+// Takes the newest task of queue `id` or, if it is empty, the oldest task of the first other queue that has one
+bool WL_ThreadPool::Pop(unsigned id, function<void()>* task)
+{
+	for (unsigned k = 0; k < queues.size(); k++)
+	{
+		TaskQueue& queue = queues[(id + k) % queues.size()];
+		{
+			lock_guard<mutex> lock(queue.queue_mutex);
+			if (queue.tasks.empty())
+				continue;
+			if (k == 0)
+			{
+				*task = queue.tasks.back();
+				queue.tasks.pop_back();
+			}
+			else
+			{
+				*task = queue.tasks.front();
+				queue.tasks.pop_front();
+			}
+		}
+
+		lock_guard<mutex> lock(state_mutex);
+		queued--;
+		return true;
+	}
+
+	return false;
+}
+
+void WL_ThreadPool::Work(unsigned id)
+{
+	while (true)
+	{
+		function<void()> task;
+		if (Pop(id, &task))
+		{
+			task();
+
+			lock_guard<mutex> lock(state_mutex);
+			if (--pending == 0)
+				all_done.notify_all();
+			continue;
+		}
+
+		unique_lock<mutex> lock(state_mutex);
+		work_available.wait(lock, [this] { return stopping || queued > 0; });
+		if (stopping && queued == 0)
+			return;
+	}
+}
@@ -0,0 +1,44 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#ifndef _WL_THREAD_POOL
+#define _WL_THREAD_POOL
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Work-stealing thread pool: tasks are dealt round-robin to per-thread queues; each thread runs the newest
+// task of its own queue and, when it is empty, steals the oldest task of another queue (so long solves on
+// one thread do not hold back the tasks queued behind them)
+class WL_ThreadPool
+{
+public:
+	WL_ThreadPool(unsigned threads);
+	~WL_ThreadPool();
+	unsigned Threads() const { return workers.size(); }
+	void Submit(function<void()> task);
+	void Wait(); // blocks until all submitted tasks have finished
+private:
+	struct TaskQueue
+	{
+		mutex queue_mutex;
+		deque<function<void()>> tasks;
+	};
+
+	vector<TaskQueue> queues;
+	vector<thread> workers;
+	mutex state_mutex; // guards the counters below
+	condition_variable work_available, all_done;
+	unsigned pending, queued, next_queue; // tasks not finished, tasks in the queues, queue of the next task
+	bool stopping;
+	void Work(unsigned id);
+	bool Pop(unsigned id, function<void()>* task);
+};
+
+#endif
@@ -0,0 +1,232 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+// Microbenchmarks of the solver's core kernels on fixed generated instances: supply (re)assignment,
+// solution copy, one sweep of the ILS neighborhoods, each perturbation type, elite mining and instance
+// parsing. Reports the mean time (ns/op) and the mean number of heap allocations (allocs/op)
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+#include "WL_Generator.h"
+#include "WL_MRILS.h"
+
+using namespace std;
+
+// Heap allocations are counted while `counting` is set (not inlined, so that GCC does not pair the
+// allocator calls with malloc/free in the callers)
+static unsigned long allocations = 0;
+static bool counting = false;
+
+__attribute__((noinline)) void* operator new(size_t size)
+{
+	if (counting)
+		allocations++;
+	void* p = malloc(size ? size : 1);
+	if (!p)
+		throw bad_alloc();
+	return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+// Accumulates the time and allocations of the measured sections of a kernel
+class Measure
+{
+public:
+	Measure() : ops(0), ns(0), allocs(0) {}
+	void Start()
+	{
+		allocations = 0;
+		counting = true;
+		start = chrono::steady_clock::now();
+	}
+	void Stop(unsigned long n = 1)
+	{
+		ns += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+		counting = false;
+		allocs += allocations;
+		ops += n;
+	}
+	void Print(const string& kernel, const string& size) const
+	{
+		cout << left << setw(24) << kernel << setw(12) << size << right << fixed << setprecision(1)
+			 << setw(16) << (ops ? ns / ops : 0) << setw(14) << (ops ? (double)allocs / ops : 0) << setw(10) << ops << endl;
+	}
+private:
+	unsigned long ops;
+	double ns;
+	unsigned long allocs;
+	chrono::steady_clock::time_point start;
+};
+
+// Runs the kernels of a solver through its protected interface
+class WL_KernelBench : public WL_MRILS
+{
+public:
+	WL_KernelBench(WL_Instance& in, unsigned seed, unsigned repetitions)
+		: WL_MRILS(in, 1e9, seed, 10, 1.0, 0.8, 10, false, 1000, 0.0), in(in), repetitions(repetitions)
+	{
+		StartClock();
+		sol = InitialSolution();
+		LocalSearch(sol);
+	}
+	~WL_KernelBench() { delete sol; }
+
+	void Run(const string& size)
+	{
+		AssignRevoke().Print("Assign+Revoke", size);
+		Copy().Print("Copy", size);
+		Sweep().Print("Neighborhood sweep", size);
+		for (unsigned perturbation = 1; perturbation <= 5; perturbation++)
+			Perturbation(perturbation).Print("Perturbation " + to_string(perturbation), size);
+		MineElite().Print("MineElite", size);
+		Parse().Print("Parse", size);
+	}
+
+private:
+	WL_Instance& in;
+	unsigned repetitions;
+	WL_Solution* sol; // locally optimal solution the kernels start from
+
+	// RevokeAssignment followed by Assign of every supply of the solution (one op per supply)
+	Measure AssignRevoke()
+	{
+		vector<Supply> supplies;
+		for (unsigned w = 0; w < in.Warehouses(); w++)
+			for (auto it = sol->supplied_stores[w].begin(); it != sol->supplied_stores[w].end(); ++it)
+				supplies.push_back({w, *it, sol->Supply(*it, w)});
+
+		Measure measure;
+		for (unsigned r = 0; r < repetitions; r++)
+		{
+			measure.Start();
+			for (unsigned i = 0; i < supplies.size(); i++)
+			{
+				sol->RevokeAssignment(supplies[i].s, supplies[i].w, supplies[i].q);
+				sol->Assign(supplies[i].s, supplies[i].w, supplies[i].q);
+			}
+			measure.Stop(supplies.size());
+		}
+		return measure;
+	}
+
+	Measure Copy()
+	{
+		Measure measure;
+		for (unsigned r = 0; r < repetitions; r++)
+		{
+			measure.Start();
+			WL_Solution* copy = sol->Copy();
+			measure.Stop();
+			delete copy;
+		}
+		return measure;
+	}
+
+	// Move generation of the ILS for all warehouses (as after a restart)
+	Measure Sweep()
+	{
+		unordered_set<unsigned> all, none;
+		for (unsigned w = 0; w < in.Warehouses(); w++)
+			all.insert(w);
+
+		Measure measure;
+		for (unsigned r = 0; r < repetitions; r++)
+		{
+			MoveQueue moves;
+			measure.Start();
+			ComputeMoves(sol, all, none, none, &moves);
+			measure.Stop();
+		}
+		return measure;
+	}
+
+	// Perturbation of a copy of the solution (the copy is not measured)
+	Measure Perturbation(unsigned perturbation)
+	{
+		unordered_set<unsigned> invalid_warehouses, closing_forbidden, opening_forbidden;
+
+		Measure measure;
+		for (unsigned r = 0; r < repetitions; r++)
+		{
+			WL_Solution* copy = sol->Copy();
+			invalid_warehouses.clear();
+			measure.Start();
+			WL_MRILS::Perturbation(copy, &invalid_warehouses, &closing_forbidden, &opening_forbidden, perturbation);
+			measure.Stop();
+			delete copy;
+		}
+		return measure;
+	}
+
+	// Mining of an elite set of locally optimal solutions
+	Measure MineElite()
+	{
+		while (EliteSize() < EliteMaxSize())
+		{
+			WL_Solution* elite_sol = InitialSolution();
+			LocalSearch(elite_sol);
+			EliteInsert(*elite_sol);
+			delete elite_sol;
+		}
+
+		Measure measure;
+		for (unsigned r = 0; r < repetitions; r++)
+		{
+			measure.Start();
+			WL_MRILS::MineElite();
+			measure.Stop();
+		}
+		return measure;
+	}
+
+	// Parsing of the instance in .dzn format from memory
+	Measure Parse()
+	{
+		ostringstream os;
+		in.Write(os);
+		string data = os.str();
+
+		Measure measure;
+		for (unsigned r = 0; r < repetitions; r++)
+		{
+			istringstream is(data);
+			measure.Start();
+			WL_Instance* parsed = WL_Instance::Parse(is);
+			measure.Stop();
+			delete parsed;
+		}
+		return measure;
+	}
+};
+
+int main(int argc, char* argv[])
+{
+	const unsigned sizes[][2] = {{20, 100}, {50, 500}, {100, 1000}};
+	const unsigned repetitions = argc > 1 ? atoi(argv[1]) : 100;
+
+	cout << left << setw(24) << "kernel" << setw(12) << "W x S" << right << setw(16) << "ns/op" << setw(14) << "allocs/op"
+		 << setw(10) << "ops" << endl;
+
+	for (auto size : sizes)
+	{
+		WL_Instance* in = GenerateInstance(GeneratorOptions(size[0], size[1], 1));
+		WL_KernelBench bench(*in, 1, repetitions);
+		bench.Run(to_string(size[0]) + "x" + to_string(size[1]));
+		delete in;
+	}
+
+	return 0;
+}
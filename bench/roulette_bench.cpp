@@ -0,0 +1,222 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+// Construction-time benchmark of InitialSolutionRandomOpening vs. W, on generated instances with a fixed
+// number of stores: the solver's construction, which samples the warehouses to open with WL_Roulette, vs.
+// the same construction with the previous linear cumulative-probability walk over the unopened warehouses
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+#include "WL_Generator.h"
+#include "WL_MRILS.h"
+
+using namespace std;
+
+// Previous selection scheme: O(W) walk over the unopened warehouses for every sample, recomputing the
+// selection probabilities (same interface as WL_Roulette)
+class LinearRoulette
+{
+public:
+	LinearRoulette(const vector<double>& weights) : weights(weights), open(weights.size(), false), left(0), total(0)
+	{
+		for (unsigned w = 0; w < weights.size(); w++)
+			if (weights[w] > 0)
+			{
+				left++;
+				total += weights[w];
+			}
+	}
+	double Weight(unsigned w) const { return open[w] ? 0 : weights[w]; }
+	bool Empty() const { return !left; }
+	unsigned Sample(double random) const
+	{
+		double cumulative_prob = 0;
+		unsigned last = 0;
+		for (unsigned w = 0; w < weights.size(); w++)
+			if (!open[w] && weights[w] > 0)
+			{
+				double selection_prob = weights[w] / total;
+				if (random <= cumulative_prob + selection_prob)
+					return w;
+				cumulative_prob += selection_prob;
+				last = w;
+			}
+		return last;
+	}
+	void Update(unsigned w, double weight) // only to put back a removed warehouse with its weight
+	{
+		if (open[w] && weight > 0)
+		{
+			open[w] = false;
+			left++;
+			total += weights[w];
+		}
+	}
+	void Remove(unsigned w)
+	{
+		if (!open[w] && weights[w] > 0)
+		{
+			open[w] = true;
+			left--;
+			total -= weights[w];
+		}
+	}
+private:
+	const vector<double>& weights;
+	vector<bool> open;
+	unsigned left;
+	double total;
+};
+
+// InitialSolutionRandomOpening with the linear walk (a store that no sampled warehouse can supply restarts
+// the construction instead of calling RepairAssignment, which is private to the solver)
+WL_Solution* LinearConstruction(WL_Instance& in, WL_Random& rng)
+{
+	WL_Solution* sol;
+	bool feasible = false;
+
+	vector<double> weights(in.Warehouses());
+	for (unsigned w = 0; w < in.Warehouses(); w++)
+		weights[w] = in.FixedCost(w) ? (double)in.Capacity(w) / in.FixedCost(w) : (double)in.Capacity(w);
+
+	unsigned total_demand = 0;
+	for (unsigned s = 0; s < in.Stores(); s++)
+		total_demand += in.AmountOfGoods(s);
+
+	while (!feasible)
+	{
+		sol = new WL_Solution(in);
+		feasible = true;
+
+		LinearRoulette roulette(weights);
+		vector<unsigned> warehouses;
+
+		unsigned total_capacity = 0;
+		while (total_capacity < total_demand && !roulette.Empty())
+		{
+			unsigned w = roulette.Sample(rng.Uniform());
+			roulette.Remove(w);
+			warehouses.push_back(w);
+			total_capacity += in.Capacity(w);
+		}
+
+		for (unsigned w = 0; w < warehouses.size(); w++)
+		{
+			if (sol->ResidualCapacity(warehouses[w]))
+			{
+				unsigned s = rng.Below(in.Stores());
+				unsigned trials = 0;
+				while (!sol->ResidualAmount(s) || sol->Incompatibilities(warehouses[w], s))
+				{
+					if (++trials > in.Stores())
+						break;
+
+					s = rng.Below(in.Stores());
+				}
+
+				if (trials <= in.Stores())
+					sol->Assign(s, warehouses[w], min(sol->ResidualAmount(s), in.Capacity(warehouses[w])));
+			}
+		}
+
+		for (unsigned s = 0; feasible && s < in.Stores(); s++)
+		{
+			while (sol->ResidualAmount(s))
+			{
+				unsigned best_w = in.Warehouses();
+				for (unsigned w = 0; w < warehouses.size(); w++)
+					if (sol->ResidualCapacity(warehouses[w]) && !sol->Incompatibilities(warehouses[w], s) && (best_w == in.Warehouses() || in.SupplyCost(s, warehouses[w]) < in.SupplyCost(s, best_w)))
+						best_w = warehouses[w];
+
+				if (best_w == in.Warehouses())
+				{
+					vector<unsigned> skipped;
+					while (best_w == in.Warehouses() && !roulette.Empty())
+					{
+						unsigned w = roulette.Sample(rng.Uniform());
+						roulette.Remove(w);
+						if (sol->ResidualCapacity(w) && !sol->Incompatibilities(w, s))
+						{
+							warehouses.push_back(w);
+							best_w = w;
+						}
+						else
+							skipped.push_back(w);
+					}
+					for (unsigned i = 0; i < skipped.size(); i++)
+						roulette.Update(skipped[i], weights[skipped[i]]);
+
+					if (best_w == in.Warehouses())
+					{
+						feasible = false;
+						delete sol;
+						break;
+					}
+				}
+
+				sol->Assign(s, best_w, min(sol->ResidualAmount(s), sol->ResidualCapacity(best_w)));
+			}
+		}
+	}
+
+	return sol;
+}
+
+// Runs the solver's construction (random opening) through its protected interface
+class WL_ConstructionBench : public WL_MRILS
+{
+public:
+	WL_ConstructionBench(WL_Instance& in, unsigned seed) : WL_MRILS(in, 1e9, seed, 5, 0.07, 0.4, 10, true, 100, 1.01) { StartClock(); }
+	WL_Solution* Construct() { return InitialSolution(); }
+};
+
+static unsigned Opened(const WL_Solution* sol)
+{
+	unsigned opened = 0;
+	for (unsigned w = 0; w < sol->supplied_stores.size(); w++)
+		if (sol->Load(w))
+			opened++;
+	return opened;
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned sizes[] = {100, 500, 1000, 2000, 5000, 10000, 20000};
+	const unsigned stores = argc > 1 ? atoi(argv[1]) : 500;
+	const unsigned repetitions = argc > 2 ? atoi(argv[2]) : 20;
+
+	cout << setw(8) << "W" << setw(8) << "S" << setw(10) << "opened" << setw(16) << "linear (ms)" << setw(16) << "roulette (ms)"
+		 << setw(10) << "speedup" << endl;
+
+	for (unsigned W : sizes)
+	{
+		WL_Instance* in = GenerateInstance(GeneratorOptions(W, stores, W));
+
+		// Both variants build `repetitions` solutions from the same seed (only the constructions are timed);
+		// the opened warehouses are those of the solver's constructions
+		double time[2] = {0, 0};
+		double opened = 0;
+		for (unsigned variant = 0; variant < 2; variant++)
+		{
+			WL_Random rng(1);
+			WL_ConstructionBench solver(*in, 1);
+			for (unsigned r = 0; r < repetitions; r++)
+			{
+				auto start = chrono::steady_clock::now();
+				WL_Solution* sol = variant ? solver.Construct() : LinearConstruction(*in, rng);
+				time[variant] += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / repetitions;
+				if (variant)
+					opened += Opened(sol);
+				delete sol;
+			}
+		}
+
+		cout << setw(8) << W << setw(8) << stores << fixed << setprecision(1) << setw(10) << opened / repetitions << setprecision(3)
+			 << setw(16) << time[0] << setw(16) << time[1] << setprecision(1) << setw(9) << time[0] / time[1] << "x" << endl;
+		delete in;
+	}
+
+	return 0;
+}
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+# Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+"""Scaling benchmark of mrils over a ladder of synthetic instance sizes.
+
+Usage (from the repository root, after `make mrils generate`):
+    bench/scaling.py [--sizes 50x500,100x1000,...] [--timeout <s>] [--seeds <n>] [--target-gap <x>]
+                     [--generator-options "<options>"] [--workdir <dir>] [--output <csv>]
+
+Sizes are <warehouses>x<stores>. For each size an instance is generated (seed 1, see tools/generate.cpp)
+and solved with seeds 1..n, each run with a convergence trace. One CSV line per run records:
+- time_to_feasible: time of the first best solution without violations
+- time_to_target: time of the first feasible best solution within target_gap of the best final cost
+  over the runs of that size
+- peak_rss_mb: maximum resident set size of the solver process (from wait4)
+Empty fields mean the event did not happen within the timeout.
+"""
+
+import argparse
+import csv
+import os
+import subprocess
+import sys
+import time
+
+DEFAULT_SIZES = "50x500,100x1000,200x2000,500x5000,1000x10000,2000x10000,5000x10000"
+
+
+def read_trace(file_name):
+    with open(file_name, newline="") as f:
+        return [(float(r["time"]), float(r["cost"]), int(r["violations"])) for r in csv.DictReader(f) if r["source"] == "best"]
+
+
+def run(command):
+    """Runs `command`, returning its wall-clock time and peak RSS in MB (ru_maxrss is in KB on Linux)."""
+    start = time.monotonic()
+    process = subprocess.Popen(command, stdout=subprocess.DEVNULL)
+    _, status, usage = os.wait4(process.pid, 0)
+    process.returncode = os.waitstatus_to_exitcode(status)
+    if process.returncode:
+        sys.exit("%s failed with exit status %d" % (" ".join(command), process.returncode))
+    return time.monotonic() - start, usage.ru_maxrss / 1024.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--sizes", default=DEFAULT_SIZES)
+    parser.add_argument("--timeout", type=float, default=60)
+    parser.add_argument("--seeds", type=int, default=3)
+    parser.add_argument("--target-gap", type=float, default=0.01)
+    parser.add_argument("--generator-options", default="", help="extra options of tools/generate.cpp")
+    parser.add_argument("--mrils", default="./mrils")
+    parser.add_argument("--generate", default="./generate")
+    parser.add_argument("--workdir", default="scaling")
+    parser.add_argument("--output", default="-")
+    args = parser.parse_args()
+
+    os.makedirs(args.workdir, exist_ok=True)
+    out = sys.stdout if args.output == "-" else open(args.output, "w", newline="")
+    writer = csv.writer(out)
+    writer.writerow(["warehouses", "stores", "seed", "timeout", "final_cost", "violations", "time_to_best",
+                     "time_to_feasible", "time_to_target", "peak_rss_mb", "wall_time"])
+
+    for size in args.sizes.split(","):
+        warehouses, stores = (int(n) for n in size.lower().split("x"))
+        instance = os.path.join(args.workdir, "wl_%d_%d.dzn" % (warehouses, stores))
+        if not os.path.exists(instance):
+            subprocess.check_call([args.generate, instance, str(warehouses), str(stores), "1"] + args.generator_options.split())
+
+        runs = []
+        for seed in range(1, args.seeds + 1):
+            base = os.path.join(args.workdir, "wl_%d_%d_%d" % (warehouses, stores, seed))
+            wall_time, peak_rss = run([args.mrils, instance, base + ".sol", "%g" % args.timeout, str(seed), "--trace", base + ".csv"])
+            runs.append((seed, read_trace(base + ".csv"), peak_rss, wall_time))
+
+        final_costs = [trace[-1][1] for _, trace, _, _ in runs if trace and trace[-1][2] == 0]
+        target = min(final_costs) * (1 + args.target_gap) if final_costs else None
+        for seed, trace, peak_rss, wall_time in runs:
+            feasible = [(t, cost) for t, cost, violations in trace if violations == 0]
+            on_target = [t for t, cost in feasible if target is not None and cost <= target]
+            writer.writerow([warehouses, stores, seed, args.timeout,
+                             "%.2f" % trace[-1][1] if trace else "", trace[-1][2] if trace else "",
+                             "%.3f" % trace[-1][0] if trace else "",
+                             "%.3f" % feasible[0][0] if feasible else "",
+                             "%.3f" % on_target[0] if on_target else "",
+                             "%.1f" % peak_rss, "%.3f" % wall_time])
+            out.flush()
+
+
+if __name__ == "__main__":
+    main()
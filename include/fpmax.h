@@ -1,43 +1,41 @@
+#ifndef _FPMAX_CLASS
+#define _FPMAX_CLASS
+
+#include <vector>
+
+#include "data.h"
 #include "fp_tree.h"
+#include "fsout.h"
 
+// Maximal frequent itemset miner; each instance keeps its own state, so miners can run concurrently
 class FPmax
 {
 	public:
 	
 		FPmax(char const * in, char const * out, int minsup);
 		FPmax(Dataset* dataset, int minsup, unsigned int nlargest);
+		~FPmax();
 	
-		FISet* run();
-
-		int *ITlen;
-		int* bran;
-		int* prefix;
-
-		int* order_item;		// given order i, order_item[i] gives itemname
-		int* item_order;		// given item i, item_order[i] gives its new order 
-								//	order_item[item_order[i]]=i; item_order[order_item[i]]=i;
-		bool* current_fi;
-		int* compact;
-		int* supp;
-
-		MFI_tree** mfitrees;
-		CFI_tree** cfitrees;
-
-		stack* list;
-		int TRANSACTION_NO=0;
-		int ITEM_NO=100;
-		int THRESHOLD;
+		FISet* run();		// NULL for file-based output
 
-		memory* fp_buf;
-		
-		void printLen();
-	
 	private:
 		
 		Data* fdat;
 		FSout* fout;
 		int minsup;
 		unsigned int nlargest;
+		int transactions;
+
+		memory* fp_buf;		// FP-trees (released as the recursion returns)
+		memory* mfi_buf;	// MFI-tree
+		MFI_tree* mfitree;
+		std::vector<int> item_of;	// item_of[r]: item of rank r
+		std::vector<int> prefix;	// ranks of the items of the current conditional tree (the head)
+		std::vector<int> iset;
+
+		FI_tree* first_tree();
+		void mine(FI_tree* tree, int support);
+		void output(const int* ranks, int length, int support);
 };
 
 /*
@@ -63,3 +61,5 @@ Parameters:
 Returns a pointer to an FISet object - a set of FrequentItemset objects (see `fitemset.h` for their definitions)
 */
 FISet* fpmax(Dataset* dataset, unsigned int minsup, unsigned int nlargest=0);
+
+#endif
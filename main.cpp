@@ -1,106 +1,548 @@
 // Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
 
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
 
+#include "WL_Log.h"
 #include "WL_MRILS.h"
+#include "WL_Server.h"
+#include "WL_Solver.h"
+#include "WL_ThreadPool.h"
 
 using namespace std;
 
-int main(int argc, char* argv[])
+void Usage(char* program)
+{
+	cerr << "Usage: " << program << " <input_file> <solution_file> <timeout_seconds> <random_seed> [options]" << endl
+		<< "       " << program << " --batch <manifest_file> <summary_file> [--threads <n>]" << endl
+		<< "       " << program << " --serve <socket_file> [--threads <n>]" << endl
+		<< "Input file in .dzn format." << endl
+		<< "Batch mode: each line of the manifest holds <input_file> <solution_file> <timeout_seconds> <random_seed>;" << endl
+		<< "the instances are solved in parallel (by default on all cores) and a CSV summary is written." << endl
+		<< "Server mode: listens on a Unix domain socket for solve requests (see WL_Server.h for the protocol)." << endl
+		<< "Options:" << endl
+		<< "  --threads <n>              number of worker threads sharing the elite pool (default 1; with more than one," << endl
+		<< "                             results can differ between runs with the same seed, as they depend on thread timing)" << endl
+		<< "  --parallel-patterns        with several threads, solve the reduced instances of all mined patterns at once" << endl
+		<< "  --support-quantities       take pattern quantities from the elite solutions that contain the pattern" << endl
+		<< "  --pattern-schedule <s>     order of the patterns: round-robin (default), adaptive or support" << endl
+		<< "  --islands <n>              number of solver processes exchanging elite solutions and patterns (default 1)" << endl
+		<< "  --migration-interval <s>   seconds between migrations of the island model (default timeout / 20, at least 1)" << endl
+		<< "  --warm-start <file>        prior solution (in the output format) to start from; may be repeated" << endl
+		<< "  --checkpoint <file>        save the solver state to <file> periodically and at the end (per island: <file>.<i>)" << endl
+		<< "  --checkpoint-interval <s>  seconds between checkpoints (default 60)" << endl
+		<< "  --resume <file>            continue the run saved in checkpoint <file> (per island: <file>.<i>)" << endl
+		<< "  --stream-output            rewrite the solution file on every improvement (per island: <solution_file>.<i>)" << endl
+		<< "  --stream-interval <s>      minimum seconds between rewrites of --stream-output (default 1)" << endl
+		<< "  --report <file>            write a JSON report with profiling counters and timers (per island: <file>.<i>)" << endl
+		<< "  --trace <file>             write a CSV convergence trace with every improvement (per island: <file>.<i>)" << endl
+		<< "  --trace-ils                also trace the improvements of the best solution of each ILS" << endl
+		<< "  --max-iterations <n>       stop after n iterations (with the options below, the timeout is only a safeguard:" << endl
+		<< "                             a single-threaded run that stops on its budget is reproducible for a given seed)" << endl
+		<< "  --max-evaluations <n>      stop after n move evaluations of the local searches" << endl
+		<< "  --max-ils-iterations <n>   stop after n ILS iterations" << endl
+		<< "  --log-level <level>        progress messages on stderr: error, warning (default), info or debug" << endl
+		<< "                             (debug needs a build with -DWL_LOG_LEVEL=WL_LOG_DEBUG)" << endl;
+	exit(1);
+}
+
+// Writes the solution file from the printed solution `text`, replacing `file_name` atomically (readers never
+// see a partial solution)
+void WriteSolutionText(string file_name, const string& text, double time_best)
+{
+	string temp_file = file_name + ".tmp";
+	ofstream out(temp_file);
+	out << text;
+	out << "TimeToBest: " << setprecision(1) << fixed << time_best << endl;
+	out.close();
+	if (!out || rename(temp_file.c_str(), file_name.c_str()))
+		cerr << "Cannot write solution file " << file_name << endl;
+}
+
+void WriteSolution(string file_name, const WL_Solution& sol, double time_best)
+{
+	ostringstream text;
+	sol.Print(text);
+	WriteSolutionText(file_name, text.str(), time_best);
+}
+
+// Anytime output: rewrites `file_name` with the improvements passed to Improve, at most once every `interval`
+// seconds; an improvement that comes sooner is kept and written by a background thread when the interval
+// expires, so the file never lags the best solution by more than `interval` (Flush writes it right away)
+class StreamOutput
+{
+public:
+	StreamOutput(string file_name, double interval);
+	~StreamOutput(); // writes the pending solution, if any
+	void Improve(const WL_Solution& sol, double time);
+	void Flush();
+private:
+	string file_name;
+	chrono::steady_clock::duration interval;
+	mutex stream_mutex; // guards the members below
+	condition_variable changed;
+	bool pending, stopping;
+	string text; // printed pending solution
+	double time_best;
+	chrono::steady_clock::time_point next_write;
+	thread writer;
+	void Write();
+	void Work();
+};
+
+StreamOutput::StreamOutput(string file_name, double interval)
+	: file_name(file_name), interval(chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(interval))),
+	  pending(false), stopping(false), time_best(0), next_write(chrono::steady_clock::now())
+{
+	writer = thread(&StreamOutput::Work, this);
+}
+
+StreamOutput::~StreamOutput()
 {
-	string instance;
-	if (argc != 5)
 	{
-		cerr << "Usage: " << argv[0] << " <input_file> <solution_file> <timeout_seconds> <random_seed>" << endl
-			<< "Input file in .dzn format." << endl;
+		lock_guard<mutex> lock(stream_mutex);
+		stopping = true;
+	}
+	changed.notify_one();
+	writer.join();
+	Flush();
+}
+
+void StreamOutput::Improve(const WL_Solution& sol, double time)
+{
+	ostringstream printed;
+	sol.Print(printed);
+
+	lock_guard<mutex> lock(stream_mutex);
+	text = printed.str();
+	time_best = time;
+	pending = true;
+	if (chrono::steady_clock::now() >= next_write)
+		Write();
+	else
+		changed.notify_one();
+}
+
+void StreamOutput::Flush()
+{
+	lock_guard<mutex> lock(stream_mutex);
+	if (pending)
+		Write();
+}
+
+// Writes the pending solution (holding `stream_mutex`)
+void StreamOutput::Write()
+{
+	WriteSolutionText(file_name, text, time_best);
+	pending = false;
+	next_write = chrono::steady_clock::now() + interval;
+}
+
+// Writer thread: writes a pending solution once the interval since the last write expires
+void StreamOutput::Work()
+{
+	unique_lock<mutex> lock(stream_mutex);
+	while (!stopping)
+	{
+		if (!pending)
+			changed.wait(lock);
+		else if (changed.wait_until(lock, next_write) == cv_status::timeout && pending)
+			Write();
+	}
+}
+
+// `text` as a JSON string literal (quoted, with quotes, backslashes and control characters escaped)
+string JsonString(const string& text)
+{
+	ostringstream os;
+	os << '"';
+	for (unsigned char c : text)
+		if (c == '"' || c == '\\')
+			os << '\\' << c;
+		else if (c < 0x20)
+			os << "\\u" << hex << setw(4) << setfill('0') << (unsigned)c << dec << setfill(' ');
+		else
+			os << c;
+	os << '"';
+	return os.str();
+}
+
+// `text` as a CSV field (quoted, with doubled quotes, if it holds a comma, a quote or an end of line)
+string CsvField(const string& text)
+{
+	if (text.find_first_of(",\"\r\n") == string::npos)
+		return text;
+	string field = "\"";
+	for (char c : text)
+		field += c == '"' ? string("\"\"") : string(1, c);
+	return field + "\"";
+}
+
+// Writes the JSON run report: parameters, result and the profile of the solver
+void WriteReport(string file_name, string input_file, double timeout, unsigned seed, unsigned threads, WL_MRILS& solver, double time)
+{
+	ofstream out(file_name);
+	out << "{" << endl
+		<< "  \"instance\": " << JsonString(input_file) << "," << endl
+		<< "  \"timeout\": " << timeout << "," << endl
+		<< "  \"seed\": " << seed << "," << endl
+		<< "  \"threads\": " << threads << "," << endl
+		<< "  \"time\": " << time << "," << endl;
+	WL_Solution* sol = solver.Best();
+	if (sol != NULL)
+		out << "  \"cost\": " << setprecision(2) << fixed << sol->Cost() << "," << endl
+			<< "  \"supply_cost\": " << sol->SupplyCost() << "," << endl
+			<< "  \"opening_cost\": " << sol->OpeningCost() << "," << endl
+			<< "  \"violations\": " << sol->ComputeViolations() << "," << endl
+			<< "  \"time_to_best\": " << setprecision(3) << solver.TimeBest() << "," << endl << defaultfloat;
+	solver.Profile().WriteJSON(out, "  ");
+	out << "}" << endl;
+	if (!out)
+		cerr << "Cannot write report file " << file_name << endl;
+}
+
+// Pattern schedule named `name` (see Usage), or -1 if there is none
+int ParsePatternSchedule(string name)
+{
+	if (name == "round-robin")
+		return SCHEDULE_ROUND_ROBIN;
+	if (name == "adaptive")
+		return SCHEDULE_ADAPTIVE;
+	if (name == "support")
+		return SCHEDULE_SUPPORT;
+	return -1;
+}
+
+// Solve of the batch mode
+struct BatchJob
+{
+	string input_file, solution_file;
+	double timeout;
+	unsigned seed;
+	SolverResult result;
+	double time; // wall-clock seconds of the whole job (reading, solving, writing)
+	string status;
+};
+
+// Batch mode: solves the instances listed in `manifest_file` on a thread pool (one single-threaded solve per
+// instance, each with its own time budget) and writes one CSV line per instance to `summary_file`
+int Batch(string manifest_file, string summary_file, unsigned threads)
+{
+	ifstream manifest(manifest_file);
+	if (!manifest)
+	{
+		cerr << "Cannot open manifest file " << manifest_file << endl;
 		exit(1);
 	}
 
-	WL_Instance in(argv[1]);
-	unsigned timeout = stoul(argv[3]);
-	unsigned seed = stoul(argv[4]);
-	
-	// Solver params
-	unsigned elite_size, max_patterns, ils_maxiter;
-	double min_sup, stabi_param, ils_accept;
-	bool random_opening;
-	
-	if (in.Warehouses() <= 150)
+	vector<BatchJob> jobs;
+	string line;
+	for (unsigned n = 1; getline(manifest, line); n++)
 	{
-		random_opening = true;
-		ils_maxiter = 100;
-		ils_accept = 1.01;
-		
-		elite_size = 5;
-		max_patterns = 10;
-		min_sup = 0.4;
-		stabi_param = 0.07;
+		if (line.find_first_not_of(" \t\r") == string::npos || line[line.find_first_not_of(" \t")] == '#')
+			continue;
+
+		BatchJob job;
+		istringstream is(line);
+		if (!(is >> job.input_file >> job.solution_file >> job.timeout >> job.seed))
+		{
+			cerr << "Invalid line " << n << " of manifest file " << manifest_file << endl;
+			exit(1);
+		}
+		jobs.push_back(job);
 	}
-	else if (in.Warehouses() <= 600)
+
+	WL_ThreadPool pool(threads);
+	for (unsigned j = 0; j < jobs.size(); j++)
+		pool.Submit([&jobs, j] {
+			BatchJob& job = jobs[j];
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+			// A missing or malformed input fails only its own job
+			ifstream is(job.input_file);
+			WL_Instance* in = is ? WL_Instance::Parse(is) : NULL;
+			if (!in)
+			{
+				job.status = "input error";
+				job.time = 0;
+				return;
+			}
+
+			SolverOptions options = SolverOptions::ForInstance(*in, job.timeout, job.seed);
+			job.result = Solve(*in, options);
+			if (job.result.found)
+			{
+				WL_Solution sol(*in);
+				for (unsigned i = 0; i < job.result.supplies.size(); i++)
+					sol.Assign(job.result.supplies[i].s, job.result.supplies[i].w, job.result.supplies[i].q);
+				WriteSolution(job.solution_file, sol, job.result.time_best);
+				job.status = job.result.violations ? "infeasible" : "ok";
+			}
+			else
+				job.status = "no solution";
+			delete in;
+
+			job.time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		});
+	pool.Wait();
+
+	ofstream summary(summary_file);
+	summary << "instance,solution,timeout,seed,status,cost,supply_cost,opening_cost,violations,time_to_best,time" << endl;
+	for (unsigned j = 0; j < jobs.size(); j++)
 	{
-		random_opening = false;
-		ils_maxiter = 200;
-		ils_accept = 1.01;
-		
-		elite_size = 10;
-		max_patterns = 6;
-		min_sup = 0.9;
-		stabi_param = 0.03;
+		const BatchJob& job = jobs[j];
+		summary << CsvField(job.input_file) << "," << CsvField(job.solution_file) << "," << job.timeout << "," << job.seed << "," << job.status << ",";
+		if (job.status == "ok" || job.status == "infeasible")
+			summary << setprecision(2) << fixed << job.result.cost << "," << job.result.supply_cost << "," << job.result.opening_cost << ","
+					<< job.result.violations << "," << setprecision(3) << job.result.time_best << ",";
+		else
+			summary << ",,,,,";
+		summary << setprecision(3) << fixed << job.time << defaultfloat << endl;
 	}
-	else if (in.Warehouses() <= 1400)
+	if (!summary)
+	{
+		cerr << "Cannot write summary file " << summary_file << endl;
+		exit(1);
+	}
+
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	string instance;
+	if (argc >= 4 && string(argv[1]) == "--batch")
 	{
-		random_opening = false;
-		ils_maxiter = 100;
-		ils_accept = 1.05;
-		
-		elite_size = 5;
-		max_patterns = 6;
-		min_sup = 0.8;
-		stabi_param = 0.04;
+		unsigned batch_threads = thread::hardware_concurrency();
+		if (argc == 6 && string(argv[4]) == "--threads")
+			batch_threads = stoul(argv[5]);
+		else if (argc != 4)
+			Usage(argv[0]);
+		return Batch(argv[2], argv[3], batch_threads);
 	}
-	else if (in.Warehouses() <= 2000)
+	if (argc >= 3 && string(argv[1]) == "--serve")
 	{
-		random_opening = false;
-		ils_maxiter = 100;
-		ils_accept = 1.05;
-		
-		elite_size = 5;
-		max_patterns = 6;
-		min_sup = 0.8;
-		stabi_param = 0.03;
+		unsigned server_threads = 1;
+		if (argc == 5 && string(argv[3]) == "--threads")
+			server_threads = stoul(argv[4]);
+		else if (argc != 3)
+			Usage(argv[0]);
+		WL_Server server(argv[2], server_threads);
+		server.Serve();
+		return 0;
 	}
-	else
+	if (argc < 5)
+		Usage(argv[0]);
+
+	unsigned threads = 1, islands = 1;
+	double migration_interval = 0;
+	vector<string> warm_start_files;
+	string checkpoint_file, resume_file;
+	double checkpoint_interval = 60;
+	bool stream_output = false;
+	string report_file, trace_file;
+	bool trace_ils = false;
+	double stream_interval = 1;
+	bool parallel_patterns = false, support_quantities = false;
+	PatternSchedule pattern_schedule = SCHEDULE_ROUND_ROBIN;
+	WL_Budget budget;
+	for (int a = 5; a < argc; a++)
 	{
-		random_opening = false;
-		ils_maxiter = 200;
-		ils_accept = 1.02;
-		
-		elite_size = 5;
-		max_patterns = 1;
-		min_sup = 1.0;
-		stabi_param = 0.04;
+		string option = argv[a];
+		if (option == "--threads" && a + 1 < argc)
+			threads = stoul(argv[++a]);
+		else if (option == "--parallel-patterns")
+			parallel_patterns = true;
+		else if (option == "--support-quantities")
+			support_quantities = true;
+		else if (option == "--pattern-schedule" && a + 1 < argc && ParsePatternSchedule(argv[a + 1]) >= 0)
+			pattern_schedule = (PatternSchedule)ParsePatternSchedule(argv[++a]);
+		else if (option == "--islands" && a + 1 < argc)
+			islands = stoul(argv[++a]);
+		else if (option == "--migration-interval" && a + 1 < argc)
+			migration_interval = stod(argv[++a]);
+		else if (option == "--warm-start" && a + 1 < argc)
+			warm_start_files.push_back(argv[++a]);
+		else if (option == "--checkpoint" && a + 1 < argc)
+			checkpoint_file = argv[++a];
+		else if (option == "--checkpoint-interval" && a + 1 < argc)
+			checkpoint_interval = stod(argv[++a]);
+		else if (option == "--resume" && a + 1 < argc)
+			resume_file = argv[++a];
+		else if (option == "--trace" && a + 1 < argc)
+			trace_file = argv[++a];
+		else if (option == "--log-level" && a + 1 < argc && wl_log_parse_level(argv[a + 1]) >= 0)
+			wl_log_level = wl_log_parse_level(argv[++a]);
+		else if (option == "--trace-ils")
+			trace_ils = true;
+		else if (option == "--report" && a + 1 < argc)
+			report_file = argv[++a];
+		else if (option == "--stream-output")
+			stream_output = true;
+		else if (option == "--stream-interval" && a + 1 < argc)
+			stream_interval = stod(argv[++a]);
+		else if (option == "--max-iterations" && a + 1 < argc)
+			budget.iterations = stoul(argv[++a]);
+		else if (option == "--max-evaluations" && a + 1 < argc)
+			budget.evaluations = stoul(argv[++a]);
+		else if (option == "--max-ils-iterations" && a + 1 < argc)
+			budget.ils_iterations = stoul(argv[++a]);
+		else
+		{
+			cerr << "Unknown option " << option << endl;
+			Usage(argv[0]);
+		}
 	}
+
+	WL_Instance in(argv[1]);
+	double timeout = stod(argv[3]);
+	unsigned seed = stoul(argv[4]);
+
+	vector<WL_Solution*> warm_starts;
+	for (unsigned i = 0; i < warm_start_files.size(); i++)
+		warm_starts.push_back(new WL_Solution(in, warm_start_files[i]));
 	
-	srand(seed);
-	
-	WL_MRILS solver(in, timeout, seed, elite_size, stabi_param, min_sup, max_patterns, random_opening, ils_maxiter, ils_accept);
-	solver.Run();
+	SolverOptions options = SolverOptions::ForInstance(in, timeout, seed);
+	options.threads = threads;
 	
-	WL_Solution* sol = solver.Best();
+	WL_Solution* sol;
+	double time_best;
+
+	if (islands > 1)
+	{
+		// Island model: this process is the coordinator, forking one solver per island (with seeds
+		// seed, seed + 1, ...) and writing the best solution published by any of them
+		if (migration_interval <= 0)
+			migration_interval = max(1.0, timeout / 20.0);
+
+		WL_Island island(islands, in);
+		wl_log_flush(); // buffered messages must not be inherited by the islands
+		for (unsigned i = 0; i < islands; i++)
+		{
+			pid_t pid = fork();
+			if (pid < 0)
+			{
+				cerr << "Cannot fork island " << i << endl;
+				exit(1);
+			}
+			if (pid == 0)
+			{
+				island.Join(i);
+
+				WL_MRILS solver(in, timeout, seed + i, options.elite_size, options.stabi_param, options.min_sup, options.max_patterns,
+								options.random_opening, options.ils_maxiter, options.ils_accept, threads);
+				solver.SetIsland(&island, migration_interval);
+				solver.SetBudget(budget);
+				solver.SetParallelPatterns(parallel_patterns);
+				solver.SetSupportQuantities(support_quantities);
+				solver.SetPatternSchedule(pattern_schedule);
+				for (unsigned j = 0; j < warm_starts.size(); j++)
+					solver.AddInitialSolution(warm_starts[j]);
+				if (!checkpoint_file.empty())
+					solver.SetCheckpoint(checkpoint_file + "." + to_string(i), checkpoint_interval);
+				StreamOutput* stream = NULL;
+				if (stream_output)
+				{
+					stream = new StreamOutput(string(argv[2]) + "." + to_string(i), stream_interval);
+					solver.SetImprovementCallback([stream](const WL_Solution& sol, double time) { stream->Improve(sol, time); });
+				}
+				if (!resume_file.empty() && !solver.LoadCheckpoint(resume_file + "." + to_string(i)))
+				{
+					cerr << "Cannot resume from checkpoint file " << resume_file << "." << i << endl;
+					_exit(1);
+				}
+				ofstream trace;
+				if (!trace_file.empty())
+				{
+					trace.open(trace_file + "." + to_string(i));
+					solver.SetTrace(&trace, trace_ils);
+				}
+				chrono::steady_clock::time_point start = chrono::steady_clock::now();
+				solver.Run();
+				if (!report_file.empty())
+					WriteReport(report_file + "." + to_string(i), argv[1], timeout, seed + i, threads, solver,
+								chrono::duration<double>(chrono::steady_clock::now() - start).count());
+				delete stream; // _exit skips destructors and exit handlers
+				trace.close();
+				wl_log_flush();
+
+				_exit(0);
+			}
+		}
+		while (wait(NULL) > 0)
+			;
+
+		sol = island.Best(in, &time_best);
+		if (sol == NULL)
+		{
+			cerr << "No solution found by the islands" << endl;
+			exit(1);
+		}
+	}
+	else
+	{
+		WL_MRILS solver(in, timeout, seed, options.elite_size, options.stabi_param, options.min_sup, options.max_patterns,
+						options.random_opening, options.ils_maxiter, options.ils_accept, threads);
+		solver.SetBudget(budget);
+		solver.SetParallelPatterns(parallel_patterns);
+		solver.SetSupportQuantities(support_quantities);
+		solver.SetPatternSchedule(pattern_schedule);
+		for (unsigned j = 0; j < warm_starts.size(); j++)
+			solver.AddInitialSolution(warm_starts[j]);
+		if (!checkpoint_file.empty())
+			solver.SetCheckpoint(checkpoint_file, checkpoint_interval);
+		StreamOutput* stream = NULL;
+		if (stream_output)
+		{
+			stream = new StreamOutput(argv[2], stream_interval);
+			solver.SetImprovementCallback([stream](const WL_Solution& sol, double time) { stream->Improve(sol, time); });
+		}
+		if (!resume_file.empty() && !solver.LoadCheckpoint(resume_file))
+		{
+			cerr << "Cannot resume from checkpoint file " << resume_file << endl;
+			exit(1);
+		}
+		ofstream trace;
+		if (!trace_file.empty())
+		{
+			trace.open(trace_file);
+			solver.SetTrace(&trace, trace_ils);
+		}
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		solver.Run();
+		delete stream;
+		if (!report_file.empty())
+			WriteReport(report_file, argv[1], timeout, seed, threads, solver, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+
+		sol = solver.Best();
+		time_best = solver.TimeBest();
+		if (sol == NULL)
+		{
+			cerr << "No solution found" << endl;
+			exit(1);
+		}
+	}
 	
-	ofstream out(argv[2]);
-	sol->Print(out);
-	out << "TimeToBest: " << setprecision(1) << fixed << solver.TimeBest() << endl;
-	out.close();
+	WriteSolution(argv[2], *sol, time_best);
 	cout << "\nNumber of violations: " << sol->ComputeViolations() << endl;
 	cout << "Cost: " << setprecision(2) << fixed << sol->Cost() << " = " << sol->SupplyCost() << " (supply cost) + " 
 			 << sol->OpeningCost() << " (opening cost)" << endl;
-	cout << "Time to reach best solution: " << setprecision(1) << solver.TimeBest() << " s" << endl;
+	cout << "Time to reach best solution: " << setprecision(1) << time_best << " s" << endl;
 	
 	delete sol;
+	for (unsigned i = 0; i < warm_starts.size(); i++)
+		delete warm_starts[i];
 			 
 	return 0;
 }
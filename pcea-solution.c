@@ -1,7 +1,45 @@
 #include "pcea-solution.h"
+#include "WL_Log.h"
+#include "WL_Random.h"
+
+/* Globals declared in pcea-solution.h */
+FILE *fp;
+int *gBestSolution;	 // Global Best Solution
+int gBestFitness;	 // Global Best Fitness
+int gBestViolations; // Global Best Violations
+int *pop;				 // Population
+int popFitness[POPSIZE]; // Fitness of each chromosome of the evolving population
+int violations[POPSIZE];
+int *o1, *o2;	 // Offspring after mutation (1) and crossover (1,2) respectively
+int totalDemand; // store the sum of all store demands in this variable
+int warehouses, stores, incompatibilities;
+char ch;
+int *capacities, *fixedcosts, *goods;
+int *supplycosts;
+pairs *incompatiblepairs; //, *supplycosts1;
+pairs *sol1;
+int *sol;
+int solcount;
+int *fcapacities, *demand;
+int *openwarehouses;
+int *p1, *p2;
+
+wl_rng pcea_rng; // generator of the EA (see seedrandom)
+static int pcea_rng_seeded = 0; // an all-zero xoshiro state would only yield zeros
+
+// Seeds the generator of the EA with stream `stream` of seed `seed`, long-jumped so that it never overlaps
+// the streams that the solver and its workers draw from the same seed
+void seedrandom(unsigned seed, unsigned stream) {
+	wl_rng_seed(&pcea_rng, seed, stream);
+	wl_rng_long_jump(&pcea_rng);
+	pcea_rng_seeded = 1;
+}
 
-void test() {
-	printf("C code\n");
+// Uniform random integer in [0, n) (stream 0 of seed 0 unless seedrandom was called)
+int randint(int n) {
+	if (!pcea_rng_seeded)
+		seedrandom(0, 0);
+	return wl_rng_below(&pcea_rng, n);
 }
 
 void readData (char * inputfilename) {
@@ -9,7 +47,7 @@ void readData (char * inputfilename) {
 
 	fp = fopen (inputfilename, "r");
 	if (fp==NULL) {
-            printf("FILE OPEN FAILED - EXITING");
+            WL_ERROR("FILE OPEN FAILED - EXITING");
             exit(1);
     	}
 
@@ -202,6 +240,10 @@ void initpop() {
 	int i=0,j=0,k=0,t;
 	int x,y;
 	
+	// The EA starts here: use the default stream unless the caller seeded it
+	if (!pcea_rng_seeded)
+		seedrandom(0, 0);
+
 	// initialize population to all zeros
 	for (i=0; i<POPSIZE; i++) 
 		for (j=0; j<(stores+warehouses); j++) 
@@ -215,8 +257,8 @@ void initpop() {
 	
 	// 	(a) random permutation of stores
 	for (j=0; j<=stores; j++){
-		x=rand()%(stores);	// x and y are the indices of the stores to swap
-		while ((y=rand()%stores)==x);
+		x=randint(stores);	// x and y are the indices of the stores to swap
+		while ((y=randint(stores))==x);
 		t=*(pop+x);
 		*(pop+x) = *(pop+y);
 		*(pop+y) = t;
@@ -224,8 +266,8 @@ void initpop() {
 
 	// 	(b) random permutation of warehouses
 	for (j=0; j<=warehouses; j++){
-		x=rand()%warehouses+stores;	// x and y are the indices of the warehouses to swap
-		while ((y=rand()%warehouses+stores)==x);
+		x=randint(warehouses)+stores;	// x and y are the indices of the warehouses to swap
+		while ((y=randint(warehouses)+stores)==x);
 		t=*(pop+x);
 		*(pop+x) = *(pop+y);
 		*(pop+y) = t;
@@ -233,7 +275,6 @@ void initpop() {
 
 	// Make random permutations of the remaining solutions in the population
 	for (i=1; i<POPSIZE; i++) {
-	srand(i);
 	
 	// Copy previous row into this row, as is
 		for (j=0; j<(stores+warehouses); j++)
@@ -242,8 +283,8 @@ void initpop() {
 	// 	Then make a random permutation of this row
 		// (a) random permutation of stores, as before
 		for (j=0; j<stores; j++){
-			x=rand()%stores;
-			while ((y=rand()%stores)==x);
+			x=randint(stores);
+			while ((y=randint(stores))==x);
 			t=*(pop+i*(stores+warehouses)+x);
 			*(pop+i*(stores+warehouses)+x) = *(pop+i*(stores+warehouses)+y);
 			*(pop+i*(stores+warehouses)+y) = t;
@@ -251,8 +292,8 @@ void initpop() {
 		
 		// (b) random permutation of warehouses, as before
 		for (j=0; j<warehouses; j++){
-			x=rand()%warehouses+stores;
-			while ((y=rand()%warehouses+stores)==x);
+			x=randint(warehouses)+stores;
+			while ((y=randint(warehouses)+stores)==x);
 			t=*(pop+i*(stores+warehouses)+x);
 			*(pop+i*(stores+warehouses)+x) = *(pop+i*(stores+warehouses)+y);
 			*(pop+i*(stores+warehouses)+y) = t;
@@ -293,7 +334,7 @@ void initpop() {
 	
 	for (int x=0; x<(stores+warehouses); x++) 
 		gBestSolution[x] = *(pop+gBestIndex*(stores+warehouses)+x);
-if (notcorrectgbest()) {printf("\nFail inside initpop()\n");exit(1);}
+if (notcorrectgbest()) {WL_ERROR("Fail inside initpop()");exit(1);}
 	gBestFitness = bestFitness;
 	gBestViolations = min_no_of_violations;
 
@@ -323,8 +364,8 @@ void reinit() {
 	// 	Then make a random permutation of this row
 		// (a) random permutation of stores, as before
 		for (j=0; j<stores; j++){
-			x=rand()%stores;
-			while ((y=rand()%stores)==x);
+			x=randint(stores);
+			while ((y=randint(stores))==x);
 			t=*(pop+i*(stores+warehouses)+x);
 			*(pop+i*(stores+warehouses)+x) = *(pop+i*(stores+warehouses)+y);
 			*(pop+i*(stores+warehouses)+y) = t;
@@ -332,8 +373,8 @@ void reinit() {
 		
 		// (b) random permutation of warehouses, as before
 		for (j=0; j<warehouses; j++){
-			x=rand()%warehouses+stores;
-			while ((y=(rand()%warehouses)+stores)==x);
+			x=randint(warehouses)+stores;
+			while ((y=(randint(warehouses))+stores)==x);
 			t=*(pop+i*(stores+warehouses)+x);
 			*(pop+i*(stores+warehouses)+x) = *(pop+i*(stores+warehouses)+y);
 			*(pop+i*(stores+warehouses)+y) = t;
@@ -374,7 +415,7 @@ void reinit() {
 	
 	for (int x=0; x<(stores+warehouses); x++) 
 		gBestSolution[x] = *(pop+gBestIndex*(stores+warehouses)+x);
-if (notcorrectgbest()) {printf("\nFail inside reinit()\n");exit(1);}	
+if (notcorrectgbest()) {WL_ERROR("Fail inside reinit()");exit(1);}	
 	gBestFitness = bestFitness;
 	gBestViolations = min_no_of_violations;
 
@@ -753,8 +794,8 @@ void finalfitness (int str[], int *solcost, int *nviolations) {
 		o2[i] = -1;		
   }
 
-  while (((mark_l = rand()%MAX)==0)||(mark_l==(MAX-1)));
-  while (((mark_r = rand()%MAX)==mark_l)||(mark_r==0)||(mark_r==(MAX-1)));
+  while (((mark_l = randint(MAX))==0)||(mark_l==(MAX-1)));
+  while (((mark_r = randint(MAX))==mark_l)||(mark_r==0)||(mark_r==(MAX-1)));
 
   if (mark_l > mark_r) { // ensure that mark_l < mark_r
      temp = mark_l;
@@ -848,10 +889,10 @@ void finalfitness (int str[], int *solcost, int *nviolations) {
   
 // Simple Swap Mutation
  void mutation_swap (int *p1, int MAX){
-	int i = rand()%MAX;
+	int i = randint(MAX);
 	int j, t;
 	for (j=0; j<MAX; j++) o1[j] = p1[j];
-	while ((j = rand()%MAX)==i);
+	while ((j = randint(MAX))==i);
 	t = o1[i];
 	o1[i] = o1[j];
 	o1[j] = t; 
@@ -896,9 +937,9 @@ unsigned ComputeCost() // converted
 }
 
 int _2_T () {
-	int i = rand()%POPSIZE;
+	int i = randint(POPSIZE);
 	int j;
-	while ((j=rand()%POPSIZE)==i);
+	while ((j=randint(POPSIZE))==i);
 	// if both have violations, return index with lesser violation
 	if ((violations[i]>0)&&(violations[j]>0)) return ((violations[i]<violations[j])?i:j);
 	// if either one has zero violations (but not both) , return that index
@@ -910,12 +951,12 @@ int _2_T () {
 }
 
 int _3_T () {
-	int i = rand()%POPSIZE,j,k,t;
+	int i = randint(POPSIZE),j,k,t;
 	int f;
 	int best = i;
 	f = popFitness[i];
-	while ((j=rand()%POPSIZE)==i);
-	while ((k=rand()%POPSIZE)==i||k==j);
+	while ((j=randint(POPSIZE))==i);
+	while ((k=randint(POPSIZE))==i||k==j);
 
 	t=(violations[i]<violations[j])?i:j;
 	best=(violations[t]<violations[k])?t:k;
@@ -938,7 +979,7 @@ int ealoop () { // returns 1 if the best solution improved this generation, 0 ot
  int p1,p2; 
  int improvement=0;
  int temp[stores+warehouses],ofs[stores+warehouses];
- int popsel=rand()%100;
+ int popsel=randint(100);
  int operation;
  int f,v,worstv,worstf;
  int minv=INF, minf=INF;
@@ -949,7 +990,7 @@ int ealoop () { // returns 1 if the best solution improved this generation, 0 ot
  
  if (popsel<STOREBIAS) { // stores
 
-	if (rand()%100<XPROB) operation = XOVER;
+	if (randint(100)<XPROB) operation = XOVER;
 	else 
 	operation = MUTATION;
 
@@ -1018,7 +1059,7 @@ int ealoop () { // returns 1 if the best solution improved this generation, 0 ot
 	
  } else { // warehouses
 
-	if (rand()%100<XPROB) operation = XOVER;
+	if (randint(100)<XPROB) operation = XOVER;
 	else operation = MUTATION;
 
 	if (operation==XOVER) { // perform crossover, select the better fit of the two individuals
@@ -1070,14 +1111,14 @@ int ealoop () { // returns 1 if the best solution improved this generation, 0 ot
  if ((minv==gBestViolations)&&(minf<gBestFitness)) {
 	gBestFitness = minf;
 	for (int x=0; x<stores+warehouses; x++) gBestSolution[x] = ofs[x];
-if (notcorrectgbest()) {printf("\nFail inside EAloop():ofs1\n");exit(1);}
+if (notcorrectgbest()) {WL_ERROR("Fail inside EAloop():ofs1");exit(1);}
 	improvement=1;
  }
  if (minv < gBestViolations){
 	gBestViolations = minv;
 	gBestFitness = minf;
 	for (int x=0; x<stores+warehouses; x++) gBestSolution[x] = ofs[x];	
-if (notcorrectgbest()) {printf("\nFail inside EALoop():ofs2\n");exit(1);}	
+if (notcorrectgbest()) {WL_ERROR("Fail inside EALoop():ofs2");exit(1);}	
 	improvement=1;
  }
  
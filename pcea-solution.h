@@ -18,35 +18,35 @@
 #define STOREBIAS 50 // % bias toward store Xover and Mutation
 #define MAX_IMPROVE_LIMIT 10000
 
-/* Global Declarations */
+/* Global Declarations (defined in pcea-solution.c) */
 
-FILE *fp;
+extern FILE *fp;
 
 typedef struct s_tag
 {
 	int x, y, v;
 } pairs;
 
-int *gBestSolution;	 // Global Best Solution
-int gBestFitness;	 // Global Best Fitness
-int gBestViolations; // Global Best Violations
+extern int *gBestSolution;	 // Global Best Solution
+extern int gBestFitness;	 // Global Best Fitness
+extern int gBestViolations; // Global Best Violations
 //int gBestCount=-1; // Global Best Fitness
-int *pop;				 // Population
-int popFitness[POPSIZE]; // Fitness of each chromosome of the evolving population
-int violations[POPSIZE];
-int *o1, *o2;	 // Offspring after mutation (1) and crossover (1,2) respectively
-int totalDemand; // store the sum of all store demands in this variable
-int warehouses, stores, incompatibilities;
-char ch;
-int *capacities, *fixedcosts, *goods;
-int *supplycosts;
-pairs *incompatiblepairs; //, *supplycosts1;
-pairs *sol1;
-int *sol;
-int solcount;
-int *fcapacities, *demand;
-int *openwarehouses;
-int *p1, *p2;
+extern int *pop;				 // Population
+extern int popFitness[POPSIZE]; // Fitness of each chromosome of the evolving population
+extern int violations[POPSIZE];
+extern int *o1, *o2;	 // Offspring after mutation (1) and crossover (1,2) respectively
+extern int totalDemand; // store the sum of all store demands in this variable
+extern int warehouses, stores, incompatibilities;
+extern char ch;
+extern int *capacities, *fixedcosts, *goods;
+extern int *supplycosts;
+extern pairs *incompatiblepairs; //, *supplycosts1;
+extern pairs *sol1;
+extern int *sol;
+extern int solcount;
+extern int *fcapacities, *demand;
+extern int *openwarehouses;
+extern int *p1, *p2;
 
 /* Function declarations */
 void fitness(int[], int *, int *);
@@ -74,5 +74,6 @@ void display(int *, int);
 int ealoop(void);
 int compare1(const void *, const void *);
 void printSol(char *, double);
-void test();
+void seedrandom(unsigned, unsigned);
+int randint(int);
 #endif
@@ -0,0 +1,131 @@
+/*
+   Memory buffers of the FPmax miner: nodes and arrays of the prefix trees are carved from large blocks
+   and released all at once, or down to a mark (so the conditional trees of a recursion level are freed
+   when it returns).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "buffer.h"
+
+memory::memory()
+	: BUFPOS(40), BUFS_BIG(6291456), BUFS_SMALL(2097152), BUFSBSWITCH(2)
+{
+	init();
+}
+
+memory::memory(int bufpos, long bufs_small, long bufs_big, int bufsbswitch)
+	: BUFPOS(bufpos), BUFS_BIG(bufs_big), BUFS_SMALL(bufs_small), BUFSBSWITCH(bufsbswitch)
+{
+	init();
+}
+
+memory::~memory()
+{
+	for (int i = 0; i < BUFPOS; i++)
+		free(buffer[i]);
+	free(buffer);
+	free(start);
+	free(rest);
+	free(restsize);
+}
+
+void memory::init()
+{
+	buffer = (char**)calloc(BUFPOS, sizeof(char*));
+	start = (char**)calloc(BUFPOS, sizeof(char*));
+	rest = (unsigned int*)calloc(BUFPOS, sizeof(unsigned int));
+	restsize = (unsigned int*)calloc(BUFPOS, sizeof(unsigned int));
+	if (!buffer || !start || !rest || !restsize)
+	{
+		fprintf(stderr, "FPmax: out of memory\n");
+		exit(1);
+	}
+
+	bufcount = -1;
+	switchbuf(0);
+	markbuf = start[0];
+	markcount = 0;
+	markrest = rest[0];
+}
+
+// Moves to the next buffer, with room for at least `i` bytes (allocating or enlarging it if needed)
+int memory::switchbuf(unsigned int i)
+{
+	bufcount++;
+	if (bufcount == BUFPOS)
+	{
+		int bufpos = 2 * BUFPOS;
+		buffer = (char**)realloc(buffer, bufpos * sizeof(char*));
+		start = (char**)realloc(start, bufpos * sizeof(char*));
+		rest = (unsigned int*)realloc(rest, bufpos * sizeof(unsigned int));
+		restsize = (unsigned int*)realloc(restsize, bufpos * sizeof(unsigned int));
+		if (!buffer || !start || !rest || !restsize)
+		{
+			fprintf(stderr, "FPmax: out of memory\n");
+			exit(1);
+		}
+		for (int j = BUFPOS; j < bufpos; j++)
+		{
+			buffer[j] = NULL;
+			restsize[j] = 0;
+		}
+		BUFPOS = bufpos;
+	}
+
+	if (restsize[bufcount] < i)
+	{
+		unsigned int size = bufcount < BUFSBSWITCH ? BUFS_SMALL : BUFS_BIG;
+		if (size < i)
+			size = i;
+		free(buffer[bufcount]);
+		buffer[bufcount] = (char*)malloc(size);
+		if (!buffer[bufcount])
+		{
+			fprintf(stderr, "FPmax: out of memory\n");
+			exit(1);
+		}
+		restsize[bufcount] = size;
+	}
+
+	start[bufcount] = buffer[bufcount];
+	rest[bufcount] = restsize[bufcount];
+	return 1;
+}
+
+// Returns room for `num` elements of `size` bytes
+char* memory::newbuf(unsigned int num, unsigned int size)
+{
+	unsigned int bytes = num * size;
+	bytes = (bytes + MULTOF - 1) / MULTOF * MULTOF;
+	if (bytes > rest[bufcount])
+		switchbuf(bytes);
+
+	char* p = start[bufcount];
+	start[bufcount] += bytes;
+	rest[bufcount] -= bytes;
+	return p;
+}
+
+// Returns the current position, to be passed to freebuf along with `*MR` and `*MC`
+char* memory::bufmark(unsigned int* MR, int* MC)
+{
+	*MR = rest[bufcount];
+	*MC = bufcount;
+	return start[bufcount];
+}
+
+// Releases everything allocated after the mark (MR, MC, MB) returned by bufmark
+void memory::freebuf(unsigned int MR, int MC, char* MB)
+{
+	bufcount = MC;
+	start[MC] = MB;
+	rest[MC] = MR;
+}
+
+// Releases everything (the buffers are kept for reuse)
+void memory::buffree()
+{
+	freebuf(markrest, markcount, markbuf);
+}
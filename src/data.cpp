@@ -0,0 +1,89 @@
+/*
+   Transactions read from a file (one transaction per line, items as non-negative integers) or from a
+   Dataset in memory.
+*/
+
+#include "data.h"
+
+void Transaction::DoubleTrans(int item)
+{
+	int newlength = 2 * (item > maxlength ? item : maxlength);
+	int *temp = new int[newlength];
+	for (int i = 0; i < length; i++)
+		temp[i] = t[i];
+	delete []t;
+	t = temp;
+	maxlength = newlength;
+}
+
+Data::Data(char const *filename)
+	: dataset(NULL)
+{
+	in = fopen(filename, "rt");
+}
+
+Data::Data(Dataset* dataset)
+	: in(NULL), dataset(dataset)
+{
+	nextTransaction = dataset->begin();
+}
+
+Data::~Data()
+{
+	close();
+}
+
+int Data::isOpen()
+{
+	return in != NULL || dataset != NULL;
+}
+
+// Reads the next (non-empty) transaction into `Trans`; returns NULL at the end of the data
+Transaction *Data::getNextTransaction(Transaction* Trans)
+{
+	Trans->length = 0;
+
+	if (dataset != NULL)
+	{
+		if (nextTransaction == dataset->end())
+			return NULL;
+		for (std::set<int>::iterator it = nextTransaction->begin(); it != nextTransaction->end(); ++it)
+		{
+			if (Trans->length == Trans->maxlength)
+				Trans->DoubleTrans(Trans->length);
+			Trans->t[Trans->length++] = *it;
+		}
+		++nextTransaction;
+		return Trans;
+	}
+
+	int c, item = 0;
+	bool digits = false;
+	while ((c = getc(in)) != EOF)
+	{
+		if (c >= '0' && c <= '9')
+		{
+			item = 10 * item + c - '0';
+			digits = true;
+			continue;
+		}
+		if (digits)
+		{
+			if (Trans->length == Trans->maxlength)
+				Trans->DoubleTrans(Trans->length);
+			Trans->t[Trans->length++] = item;
+			item = 0;
+			digits = false;
+		}
+		if (c == '\n' && Trans->length)
+			return Trans;
+	}
+	if (digits)
+	{
+		if (Trans->length == Trans->maxlength)
+			Trans->DoubleTrans(Trans->length);
+		Trans->t[Trans->length++] = item;
+	}
+
+	return Trans->length ? Trans : NULL;
+}
@@ -0,0 +1,136 @@
+/*
+   FP-trees and MFI-tree of the FPmax miner (see fp_tree.h).
+*/
+
+#include <stdlib.h>
+
+#include "fp_tree.h"
+
+void Fnode::init(Fnode* par, int itemname, int count)
+{
+	this->itemname = itemname;
+	this->par = par;
+	this->count = count;
+	leftchild = rightsibling = next = NULL;
+}
+
+void Mnode::init(Mnode* par, int itemname, int level)
+{
+	this->itemname = itemname;
+	this->par = par;
+	this->level = level;
+	leftchild = rightsibling = next = NULL;
+}
+
+// Empty tree of `itemno` items (order and count are filled in by the caller)
+void FI_tree::init(memory* buf, int itemno)
+{
+	this->itemno = itemno;
+	order = (int*)buf->newbuf(itemno, sizeof(int));
+	count = (int*)buf->newbuf(itemno, sizeof(int));
+	head = (Fnode**)buf->newbuf(itemno, sizeof(Fnode*));
+	for (int i = 0; i < itemno; i++)
+		head[i] = NULL;
+	Root = (Fnode*)buf->newbuf(1, sizeof(Fnode));
+	Root->init(NULL, -1, 0);
+}
+
+// Inserts a transaction (its items of the tree, in increasing local order) `counts` times
+void FI_tree::insert(memory* buf, const int* items, int length, int counts)
+{
+	Fnode* node = Root;
+	for (int i = 0; i < length; i++)
+	{
+		Fnode* child = node->leftchild;
+		while (child != NULL && child->itemname != items[i])
+			child = child->rightsibling;
+		if (child == NULL)
+		{
+			child = (Fnode*)buf->newbuf(1, sizeof(Fnode));
+			child->init(node, items[i], 0);
+			child->rightsibling = node->leftchild;
+			node->leftchild = child;
+			child->next = head[items[i]];
+			head[items[i]] = child;
+		}
+		child->count += counts;
+		node = child;
+	}
+}
+
+bool FI_tree::Single_path() const
+{
+	for (Fnode* node = Root->leftchild; node != NULL; node = node->leftchild)
+		if (node->rightsibling != NULL)
+			return false;
+	return true;
+}
+
+// Adds to `counts[j]` the support of item j together with `item` (the items on the paths above its nodes)
+void FI_tree::conditional_pattern_base(int item, int* counts) const
+{
+	for (Fnode* node = head[item]; node != NULL; node = node->next)
+		for (Fnode* p = node->par; p != Root; p = p->par)
+			counts[p->itemname] += node->count;
+}
+
+void MFI_tree::init(memory* buf, int itemno)
+{
+	this->itemno = itemno;
+	head = (Mnode**)buf->newbuf(itemno, sizeof(Mnode*));
+	for (int i = 0; i < itemno; i++)
+		head[i] = NULL;
+	Root = (Mnode*)buf->newbuf(1, sizeof(Mnode));
+	Root->init(NULL, -1, 0);
+	MFSNo = 0;
+}
+
+// Whether `iset` is a subset of an itemset of the tree: some path through a node of its last item
+// contains its other items (the ranks decrease towards the root)
+bool MFI_tree::is_subset(const int* iset, int length) const
+{
+	if (length == 0)
+		return MFSNo > 0;
+
+	for (Mnode* node = head[iset[length - 1]]; node != NULL; node = node->next)
+	{
+		if (node->level < length)
+			continue;
+
+		int j = length - 2;
+		for (Mnode* p = node->par; j >= 0 && p != Root; p = p->par)
+		{
+			if (p->itemname == iset[j])
+				j--;
+			else if (p->itemname < iset[j])
+				break;
+		}
+		if (j < 0)
+			return true;
+	}
+
+	return false;
+}
+
+// Inserts `iset` (in increasing rank order)
+void MFI_tree::insert(memory* buf, const int* iset, int length)
+{
+	Mnode* node = Root;
+	for (int i = 0; i < length; i++)
+	{
+		Mnode* child = node->leftchild;
+		while (child != NULL && child->itemname != iset[i])
+			child = child->rightsibling;
+		if (child == NULL)
+		{
+			child = (Mnode*)buf->newbuf(1, sizeof(Mnode));
+			child->init(node, iset[i], node->level + 1);
+			child->rightsibling = node->leftchild;
+			node->leftchild = child;
+			child->next = head[iset[i]];
+			head[iset[i]] = child;
+		}
+		node = child;
+	}
+	MFSNo++;
+}
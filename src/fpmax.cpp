@@ -0,0 +1,241 @@
+/*
+   FPmax: mining of the maximal frequent itemsets (Grahne and Zhu, "Efficiently using prefix-trees in
+   mining frequent itemsets", FIMI'03).
+
+   The transactions are stored in an FP-tree; for each item, from the least to the most frequent, the
+   head (itemset of the current conditional tree) is extended with it and, unless the head and all items
+   frequent together with it are a subset of a maximal itemset already found (MFI-tree), the conditional
+   tree of the extended head is built and mined recursively. A single-path tree yields one candidate.
+   With this order, every itemset that passes the subset check is maximal.
+   Items that occur in every transaction of a conditional database belong to all the maximal itemsets of
+   its head, so they join the head instead of the conditional tree (which matters for the near-identical
+   transactions of an elite set of solutions).
+*/
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "fpmax.h"
+
+using namespace std;
+
+FPmax::FPmax(char const * in, char const * out, int minsup)
+	: fdat(new Data(in)), fout(new FSout(out)), minsup(minsup), nlargest(0), transactions(0), fp_buf(NULL), mfi_buf(NULL), mfitree(NULL)
+{
+}
+
+FPmax::FPmax(Dataset* dataset, int minsup, unsigned int nlargest)
+	: fdat(new Data(dataset)), fout(new FSout(nlargest)), minsup(minsup), nlargest(nlargest), transactions(0), fp_buf(NULL), mfi_buf(NULL), mfitree(NULL)
+{
+}
+
+FPmax::~FPmax()
+{
+	delete fdat;
+	delete fout;
+	delete fp_buf;
+	delete mfi_buf;
+}
+
+FISet* FPmax::run()
+{
+	if (!fdat->isOpen())
+	{
+		fprintf(stderr, "FPmax: cannot open the input file\n");
+		return NULL;
+	}
+	if (!fout->isOpen())
+	{
+		fprintf(stderr, "FPmax: cannot open the output file\n");
+		return NULL;
+	}
+
+	fp_buf = new memory(40, 65536, 1048576, 2);
+	mfi_buf = new memory(40, 65536, 1048576, 2);
+
+	FI_tree* tree = first_tree();
+	mfitree = (MFI_tree*)mfi_buf->newbuf(1, sizeof(MFI_tree));
+	mfitree->init(mfi_buf, item_of.size());
+	mine(tree, transactions);
+
+	fdat->close();
+	fout->close();
+	return fout->getFrequentItemsets();
+}
+
+// Renames the frequent items to ranks and builds the FP-tree of the transactions
+FI_tree* FPmax::first_tree()
+{
+	vector<vector<int>> transactions;
+	vector<int> items;
+	prefix.clear();
+	Transaction trans;
+	while (fdat->getNextTransaction(&trans) != NULL)
+	{
+		vector<int> transaction(trans.t, trans.t + trans.length);
+		sort(transaction.begin(), transaction.end());
+		transaction.erase(unique(transaction.begin(), transaction.end()), transaction.end());
+		items.insert(items.end(), transaction.begin(), transaction.end());
+		transactions.push_back(transaction);
+	}
+
+	// Frequent items in decreasing order of support (ties by item)
+	sort(items.begin(), items.end());
+	vector<pair<int, int>> frequent; // (-support, item)
+	for (unsigned i = 0, j; i < items.size(); i = j)
+	{
+		for (j = i + 1; j < items.size() && items[j] == items[i]; j++)
+			;
+		if ((int)(j - i) >= minsup)
+			frequent.push_back(make_pair(-(int)(j - i), items[i]));
+	}
+	sort(frequent.begin(), frequent.end());
+
+	// Items of all transactions (the first ranks) form the initial head, the others the tree
+	unsigned full = 0;
+	while (full < frequent.size() && -frequent[full].first == (int)transactions.size())
+		prefix.push_back(full++);
+	FI_tree* tree = (FI_tree*)fp_buf->newbuf(1, sizeof(FI_tree));
+	tree->init(fp_buf, frequent.size() - full);
+	vector<pair<int, int>> rank_of(frequent.size()); // (item, rank), sorted by item
+	item_of.resize(frequent.size());
+	for (unsigned r = 0; r < frequent.size(); r++)
+	{
+		item_of[r] = frequent[r].second;
+		if (r >= full)
+		{
+			tree->order[r - full] = r;
+			tree->count[r - full] = -frequent[r].first;
+		}
+		rank_of[r] = make_pair(frequent[r].second, r);
+	}
+	sort(rank_of.begin(), rank_of.end());
+	this->transactions = transactions.size();
+
+	vector<int> ranks;
+	for (unsigned t = 0; t < transactions.size(); t++)
+	{
+		ranks.clear();
+		for (unsigned i = 0; i < transactions[t].size(); i++)
+		{
+			vector<pair<int, int>>::iterator it = lower_bound(rank_of.begin(), rank_of.end(), make_pair(transactions[t][i], 0));
+			if (it != rank_of.end() && it->first == transactions[t][i] && it->second >= (int)full)
+				ranks.push_back(it->second - full);
+		}
+		sort(ranks.begin(), ranks.end());
+		tree->insert(fp_buf, ranks.data(), ranks.size(), 1);
+	}
+
+	return tree;
+}
+
+// Mines the conditional tree of the current head (`prefix`, with support `support`)
+void FPmax::mine(FI_tree* tree, int support)
+{
+	if (tree->Single_path())
+	{
+		iset = prefix;
+		for (Fnode* node = tree->Root->leftchild; node != NULL; node = node->leftchild)
+		{
+			iset.push_back(tree->order[node->itemname]);
+			support = node->count;
+		}
+		sort(iset.begin(), iset.end());
+		if (!iset.empty() && !mfitree->is_subset(iset.data(), iset.size()))
+		{
+			mfitree->insert(mfi_buf, iset.data(), iset.size());
+			output(iset.data(), iset.size(), support);
+		}
+		return;
+	}
+
+	for (int i = tree->itemno - 1; i >= 0; i--)
+	{
+		unsigned int MR;
+		int MC;
+		char* MB = fp_buf->bufmark(&MR, &MC);
+
+		int* counts = (int*)fp_buf->newbuf(i, sizeof(int));
+		for (int j = 0; j < i; j++)
+			counts[j] = 0;
+		tree->conditional_pattern_base(i, counts);
+
+		// Head extended with item i (and the items of all its transactions), and the items frequent
+		// together with it (its tail)
+		unsigned head_length = prefix.size();
+		prefix.push_back(tree->order[i]);
+		vector<pair<int, int>> tail; // (-support, local item)
+		for (int j = 0; j < i; j++)
+			if (counts[j] == tree->count[i])
+				prefix.push_back(tree->order[j]);
+			else if (counts[j] >= minsup)
+				tail.push_back(make_pair(-counts[j], j));
+		iset = prefix;
+		for (unsigned k = 0; k < tail.size(); k++)
+			iset.push_back(tree->order[tail[k].second]);
+		sort(iset.begin(), iset.end());
+
+		if (!mfitree->is_subset(iset.data(), iset.size()))
+		{
+			if (tail.empty())
+			{
+				mfitree->insert(mfi_buf, iset.data(), iset.size());
+				output(iset.data(), iset.size(), tree->count[i]);
+			}
+			else
+			{
+				// Conditional tree of the extended head, its items in decreasing order of support
+				sort(tail.begin(), tail.end());
+				FI_tree* conditional = (FI_tree*)fp_buf->newbuf(1, sizeof(FI_tree));
+				conditional->init(fp_buf, tail.size());
+				int* local = (int*)fp_buf->newbuf(i, sizeof(int));
+				for (int j = 0; j < i; j++)
+					local[j] = -1;
+				for (unsigned k = 0; k < tail.size(); k++)
+				{
+					local[tail[k].second] = k;
+					conditional->order[k] = tree->order[tail[k].second];
+					conditional->count[k] = -tail[k].first;
+				}
+
+				int* path = (int*)fp_buf->newbuf(tail.size(), sizeof(int));
+				for (Fnode* node = tree->head[i]; node != NULL; node = node->next)
+				{
+					int length = 0;
+					for (Fnode* p = node->par; p != tree->Root; p = p->par)
+						if (local[p->itemname] >= 0)
+							path[length++] = local[p->itemname];
+					sort(path, path + length);
+					conditional->insert(fp_buf, path, length, node->count);
+				}
+
+				mine(conditional, tree->count[i]);
+			}
+		}
+
+		prefix.resize(head_length);
+		fp_buf->freebuf(MR, MC, MB);
+	}
+}
+
+// Writes the itemset of the items with ranks `ranks`
+void FPmax::output(const int* ranks, int length, int support)
+{
+	vector<int> items(length);
+	for (int i = 0; i < length; i++)
+		items[i] = item_of[ranks[i]];
+	fout->printSet(length, items.data(), support);
+}
+
+void fpmax(char const * in, char const * out, unsigned int minsup)
+{
+	FPmax miner(in, out, minsup);
+	miner.run();
+}
+
+FISet* fpmax(Dataset* dataset, unsigned int minsup, unsigned int nlargest)
+{
+	FPmax miner(dataset, minsup, nlargest);
+	return miner.run();
+}
@@ -0,0 +1,110 @@
+/*
+   Output of the frequent itemsets: to a file (one itemset per line: size, support and items) or to an
+   in-memory FISet, optionally keeping only the largest ones.
+*/
+
+#include "fsout.h"
+
+FrequentItemset::FrequentItemset(int support)
+	: itemsetSupport(support)
+{
+}
+
+void FrequentItemset::insert(int item)
+{
+	itemset.insert(item);
+}
+
+int FrequentItemset::support() const
+{
+	return itemsetSupport;
+}
+
+std::size_t FrequentItemset::size() const
+{
+	return itemset.size();
+}
+
+std::set<int>::iterator FrequentItemset::begin() const
+{
+	return itemset.begin();
+}
+
+std::set<int>::iterator FrequentItemset::end() const
+{
+	return itemset.end();
+}
+
+FSout::FSout(char const *filename)
+	: frequentItemsets(NULL), nlargest(0)
+{
+	out = fopen(filename, "wt");
+}
+
+FSout::FSout(unsigned int nlargest)
+	: out(NULL), frequentItemsets(new FISet), nlargest(nlargest)
+{
+}
+
+FSout::~FSout()
+{
+	close();
+	delete frequentItemsets;
+}
+
+int FSout::isOpen()
+{
+	return out != NULL || frequentItemsets != NULL;
+}
+
+void FSout::printset(int length, int *iset)
+{
+	if (out != NULL)
+	{
+		for (int i = 0; i < length; i++)
+			fprintf(out, i ? " %d" : "%d", iset[i]);
+		fprintf(out, "\n");
+	}
+	else
+		printSet(length, iset, 0);
+}
+
+void FSout::printSet(int length, int *iset, int support)
+{
+	if (out != NULL)
+	{
+		fprintf(out, "%d %d", length, support);
+		for (int i = 0; i < length; i++)
+			fprintf(out, " %d", iset[i]);
+		fprintf(out, "\n");
+		return;
+	}
+	if (frequentItemsets == NULL)
+		return;
+
+	// The set is ordered by decreasing size; a full set only takes itemsets at least as large as its last one
+	if (nlargest && frequentItemsets->size() == nlargest && (std::size_t)length < (--frequentItemsets->end())->size())
+		return;
+
+	FrequentItemset itemset(support);
+	for (int i = 0; i < length; i++)
+		itemset.insert(iset[i]);
+	frequentItemsets->insert(itemset);
+	if (nlargest && frequentItemsets->size() > nlargest)
+		frequentItemsets->erase(--frequentItemsets->end());
+}
+
+void FSout::close()
+{
+	if (out != NULL)
+		fclose(out);
+	out = NULL;
+}
+
+// Hands the in-memory itemsets over to the caller
+FISet* FSout::getFrequentItemsets()
+{
+	FISet* itemsets = frequentItemsets;
+	frequentItemsets = NULL;
+	return itemsets;
+}
@@ -0,0 +1,91 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#ifndef _BRUTE_MFI
+#define _BRUTE_MFI
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include "data.h"
+
+using namespace std;
+
+// Maximal frequent itemsets of `dataset` (at most 20 transactions) by enumeration: every frequent itemset
+// is contained in the intersection of some `minsup` transactions, so the maximal ones are the maximal
+// nonempty intersections of exactly `minsup` transactions
+set<set<int>> BruteMaximal(const Dataset& dataset, unsigned minsup)
+{
+	vector<set<int>> transactions(dataset.begin(), dataset.end());
+	unsigned n = transactions.size();
+	vector<set<int>> candidates;
+	for (unsigned mask = 1; mask < (1u << n); mask++)
+	{
+		if ((unsigned)__builtin_popcount(mask) != minsup)
+			continue;
+		set<int> common;
+		bool first = true;
+		for (unsigned t = 0; t < n; t++)
+			if (mask >> t & 1)
+			{
+				if (first)
+					common = transactions[t];
+				else
+				{
+					set<int> both;
+					set_intersection(common.begin(), common.end(), transactions[t].begin(), transactions[t].end(), inserter(both, both.begin()));
+					common.swap(both);
+				}
+				first = false;
+			}
+		if (!common.empty())
+			candidates.push_back(common);
+	}
+
+	set<set<int>> maximal;
+	for (unsigned i = 0; i < candidates.size(); i++)
+	{
+		bool contained = false;
+		for (unsigned j = 0; j < candidates.size() && !contained; j++)
+			contained = candidates[j].size() > candidates[i].size()
+				&& includes(candidates[j].begin(), candidates[j].end(), candidates[i].begin(), candidates[i].end());
+		if (!contained)
+			maximal.insert(candidates[i]);
+	}
+	return maximal;
+}
+
+// Number of transactions of `dataset` containing `itemset`
+unsigned Support(const Dataset& dataset, const set<int>& itemset)
+{
+	unsigned support = 0;
+	for (auto it = dataset.begin(); it != dataset.end(); ++it)
+		if (includes(it->begin(), it->end(), itemset.begin(), itemset.end()))
+			support++;
+	return support;
+}
+
+// Random dataset of 1 to `max_transactions` transactions over items 3, 10, 17, ... (and, if `common`, an
+// item in every transaction), each item drawn with a random density
+Dataset RandomDataset(unsigned max_transactions, unsigned max_items, bool common)
+{
+	Dataset dataset;
+	unsigned n = 1 + rand() % max_transactions, items = 2 + rand() % (max_items - 1);
+	double density = (rand() % 90 + 5) / 100.0;
+	for (unsigned t = 0; t < n; t++)
+	{
+		set<int> transaction;
+		for (unsigned k = 0; k < items; k++)
+			if (rand() < density * RAND_MAX)
+				transaction.insert(k * 7 + 3);
+		if (common)
+			transaction.insert(1000);
+		dataset.push_back(transaction);
+	}
+	return dataset;
+}
+
+#endif
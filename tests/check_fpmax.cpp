@@ -0,0 +1,44 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+// Compares the itemsets and supports mined by FPmax on random datasets with a brute-force enumeration
+
+#include <cstdio>
+
+#include "brute_mfi.h"
+#include "fpmax.h"
+
+int main()
+{
+	const unsigned trials = 3000;
+	unsigned mismatches = 0;
+	srand(1);
+
+	for (unsigned trial = 0; trial < trials; trial++)
+	{
+		Dataset dataset = RandomDataset(10, 26, trial % 2);
+		unsigned minsup = 1 + rand() % dataset.size();
+		set<set<int>> expected = BruteMaximal(dataset, minsup);
+
+		FISet* mined = fpmax(&dataset, minsup);
+		set<set<int>> itemsets;
+		bool supports = true;
+		for (auto it = mined->begin(); it != mined->end(); ++it)
+		{
+			set<int> itemset(it->begin(), it->end());
+			itemsets.insert(itemset);
+			if (Support(dataset, itemset) != (unsigned)it->support())
+				supports = false;
+		}
+
+		if (itemsets != expected || itemsets.size() != mined->size() || !supports)
+		{
+			if (++mismatches <= 5)
+				printf("trial %u (%u transactions, minsup %u): %u itemsets mined, %u expected%s\n", trial, (unsigned)dataset.size(), minsup,
+					   (unsigned)mined->size(), (unsigned)expected.size(), supports ? "" : ", wrong supports");
+		}
+		delete mined;
+	}
+
+	printf("fpmax: %u of %u trials mismatched\n", mismatches, trials);
+	return mismatches ? 1 : 0;
+}
@@ -0,0 +1,84 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+// Compares the itemsets mined by the bitmask miner (MineMaximal and WL_MinerIndex) on random datasets with
+// a brute-force enumeration
+
+#include <cstdio>
+#include <map>
+
+#include "brute_mfi.h"
+#include "WL_Miner.h"
+
+// Checks `mined` against the brute-force itemsets, its order (decreasing size) and its `nlargest` prefix
+static bool Matches(const vector<vector<unsigned>>& mined, const vector<vector<unsigned>>& largest, unsigned nlargest,
+					const set<set<int>>& expected)
+{
+	set<set<int>> itemsets;
+	for (unsigned k = 0; k < mined.size(); k++)
+	{
+		itemsets.insert(set<int>(mined[k].begin(), mined[k].end()));
+		if (k && mined[k].size() > mined[k - 1].size())
+			return false;
+	}
+	if (itemsets != expected || itemsets.size() != mined.size() || largest.size() != min<size_t>(nlargest, mined.size()))
+		return false;
+	for (unsigned k = 0; k < largest.size(); k++)
+		if (largest[k] != mined[k])
+			return false;
+	return true;
+}
+
+int main()
+{
+	const unsigned trials = 5000, nlargest = 3;
+	unsigned mismatches = 0;
+	srand(2);
+
+	for (unsigned trial = 0; trial < trials; trial++)
+	{
+		Dataset dataset = RandomDataset(MINER_MAX_TRANSACTIONS - 4, 30, trial % 2);
+		unsigned n = dataset.size(), minsup = 1 + rand() % n;
+		set<set<int>> expected = BruteMaximal(dataset, minsup);
+
+		map<int, uint32_t> masks;
+		unsigned t = 0;
+		for (auto it = dataset.begin(); it != dataset.end(); ++it, t++)
+			for (auto item = it->begin(); item != it->end(); ++item)
+				masks[*item] |= 1u << t;
+		vector<MinerItem> items;
+		for (auto it = masks.begin(); it != masks.end(); ++it)
+			items.push_back({(unsigned)it->first, it->second});
+		bool function_ok = Matches(MineMaximal(items, n, minsup), MineMaximal(items, n, minsup, nlargest), nlargest, expected);
+
+		// The index gets up to 4 extra transactions in between, removed before mining, so that free slots
+		// are left among the used ones; the quantity of an item in transaction t is item + 100 + t
+		WL_MinerIndex index;
+		vector<unsigned> extra;
+		t = 0;
+		for (auto it = dataset.begin(); it != dataset.end(); ++it, t++)
+		{
+			if (extra.size() < 4 && rand() % 3 == 0)
+				extra.push_back(index.Insert({{5000, 1}, {5001, 1}}));
+			vector<pair<unsigned, unsigned>> transaction;
+			for (auto item = it->begin(); item != it->end(); ++item)
+				transaction.push_back(make_pair((unsigned)*item, (unsigned)*item + 100 + t));
+			index.Insert(transaction);
+		}
+		for (unsigned k = 0; k < extra.size(); k++)
+			index.Remove(extra[k]);
+		bool index_ok = index.Transactions() == n
+			&& Matches(index.MineMaximal(minsup), index.MineMaximal(minsup, nlargest), nlargest, expected);
+		for (auto it = masks.begin(); it != masks.end(); ++it)
+			if (index.MinQuantity(it->first) != (unsigned)it->first + 100 + __builtin_ctz(it->second))
+				index_ok = false;
+
+		if (!function_ok || !index_ok)
+		{
+			if (++mismatches <= 5)
+				printf("trial %u (%u transactions, minsup %u): %s mismatched\n", trial, n, minsup, function_ok ? "WL_MinerIndex" : "MineMaximal");
+		}
+	}
+
+	printf("miner: %u of %u trials mismatched\n", mismatches, trials);
+	return mismatches ? 1 : 0;
+}
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+# Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+"""Kills budgeted runs that checkpoint after every iteration and checks that resuming them gives the solution
+of the uninterrupted run.
+
+Usage: test_resume.py <mrils_binary> <dzn_file>
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+SEED = "2"
+ITERATIONS = "80"
+
+
+def solution(file_name):
+    with open(file_name) as f:
+        return [line for line in f if not line.startswith("TimeToBest")]
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.exit(__doc__)
+    binary, dzn_file = os.path.abspath(argv[1]), os.path.abspath(argv[2])
+    directory = tempfile.mkdtemp()
+    try:
+        # (not the adaptive schedule, which weighs the patterns by their measured times)
+        for schedule in ["round-robin", "support"]:
+            run = [binary, dzn_file, None, "300", SEED, "--max-iterations", ITERATIONS, "--pattern-schedule", schedule]
+            checkpoint = os.path.join(directory, "checkpoint")
+
+            full = os.path.join(directory, "full.sol")
+            start = time.time()
+            subprocess.check_call(run[:2] + [full] + run[3:], stdout=subprocess.DEVNULL)
+            duration = time.time() - start
+
+            # Kills at fractions of the uninterrupted run, so that they land in its middle on any machine
+            for fraction in [0.3, 0.6]:
+                if os.path.exists(checkpoint):
+                    os.remove(checkpoint)
+                killed = subprocess.Popen(run[:2] + [os.path.join(directory, "killed.sol")] + run[3:] +
+                                          ["--checkpoint", checkpoint, "--checkpoint-interval", "0"], stdout=subprocess.DEVNULL)
+                time.sleep(fraction * duration)
+                killed.kill()
+                killed.wait()
+                if not os.path.exists(checkpoint):
+                    continue
+
+                resumed = os.path.join(directory, "resumed.sol")
+                subprocess.check_call(run[:2] + [resumed] + run[3:] + ["--resume", checkpoint], stdout=subprocess.DEVNULL)
+                if solution(resumed) != solution(full):
+                    sys.exit("%s schedule: the run resumed after a kill at %.1f s differs from the uninterrupted run"
+                             % (schedule, fraction * duration))
+    finally:
+        shutil.rmtree(directory)
+
+    print("resume: ok")
+
+
+if __name__ == "__main__":
+    main(sys.argv)
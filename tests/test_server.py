@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+# Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+"""Starts the solver daemon and checks its replies to a session of requests.
+
+Usage: test_server.py <mrils_binary> <dzn_file>
+"""
+
+import os
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tools"))
+from mrils_client import request
+
+
+def check(reply, prefix, lines=1):
+    status = reply.split("\n")[0]
+    if not status.startswith(prefix) or reply.count("\n") != lines:
+        sys.exit("unexpected reply %r (expected %r)" % (reply, prefix))
+    return status.split()[1:]
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.exit(__doc__)
+    binary, dzn_file = os.path.abspath(argv[1]), os.path.abspath(argv[2])
+    with open(dzn_file, "rb") as f:
+        contents = f.read()
+
+    directory = tempfile.mkdtemp()
+    socket_file = os.path.join(directory, "mrils.sock")
+
+    # A regular file in place of the socket must be left alone
+    open(socket_file, "w").close()
+    if subprocess.call([binary, "--serve", socket_file], stderr=subprocess.DEVNULL) == 0 or not os.path.isfile(socket_file):
+        sys.exit("the server replaced a regular file")
+    os.remove(socket_file)
+
+    server = subprocess.Popen([binary, "--serve", socket_file])
+    try:
+        for _ in range(100):
+            if os.path.exists(socket_file):
+                break
+            time.sleep(0.1)
+
+        warehouses, stores = check(request(socket_file, b"LOAD a %s\n" % dzn_file.encode()), "OK")
+        if check(request(socket_file, b"INSTANCE b %d\n" % len(contents) + contents), "OK") != [warehouses, stores]:
+            sys.exit("LOAD and INSTANCE disagree")
+        half = contents[:len(contents) // 2]
+        check(request(socket_file, b"INSTANCE c %d\n" % len(half) + half), "ERROR")
+        check(request(socket_file, b"INSTANCE c %d\n" % (1 << 40)), "ERROR payload too large")
+
+        cost, violations, _ = check(request(socket_file, b"SOLVE a 1\n"), "OK", 2)
+        if violations != "0":
+            sys.exit("infeasible solution")
+
+        delta = b"DELTA a 2 1\ngoods 1 1\nfixed_cost 1 0\n"
+        new_cost, violations = check(request(socket_file, delta), "OK")
+        if violations != "0" or float(new_cost) > float(cost):
+            sys.exit("the delta does not lower the cost of the repaired solution")
+        check(request(socket_file, b"DELTA a 1 1\ngoods %d 1\n" % (int(stores) + 1)), "ERROR")
+        check(request(socket_file, b"SOLVE a 1\n"), "OK", 2)
+
+        check(request(socket_file, b"DROP a\n"), "OK")
+        check(request(socket_file, b"SOLVE a 1\n"), "ERROR unknown instance")
+        check(request(socket_file, b"DROP b\n"), "OK")
+        check(request(socket_file, b"SHUTDOWN\n"), "OK")
+        if server.wait(10) != 0:
+            sys.exit("the server failed")
+    finally:
+        if server.poll() is None:
+            server.kill()
+        shutil.rmtree(directory)
+
+    print("server: ok")
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,75 @@
+// Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+
+#include <fstream>
+#include <iostream>
+
+#include "WL_Generator.h"
+
+using namespace std;
+
+void Usage(char* program)
+{
+	cerr << "Usage: " << program << " <output_file> <warehouses> <stores> <random_seed> [options]" << endl
+		<< "Writes a synthetic instance in .dzn format." << endl
+		<< "Options:" << endl
+		<< "  --tightness <x>                total capacity / total amount of goods (default 1.5)" << endl
+		<< "  --max-goods <n>                goods of each store in [1, n] (default 40)" << endl
+		<< "  --fixed-cost <n>               mean fixed cost (default 500)" << endl
+		<< "  --fixed-cost-spread <x>        fixed costs in mean * [1 - x, 1 + x] (default 0.5)" << endl
+		<< "  --costs <euclidean|random>     supply cost structure (default random)" << endl
+		<< "  --max-supply-cost <n>          supply costs in [1, n] (default 100)" << endl
+		<< "  --incompatibility-density <x>  fraction of incompatible store pairs, at most 0.5 (default: one pair per store)" << endl;
+	exit(1);
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 5)
+		Usage(argv[0]);
+
+	GeneratorOptions options(stoul(argv[2]), stoul(argv[3]), stoul(argv[4]));
+	for (int a = 5; a < argc; a++)
+	{
+		string option = argv[a];
+		if (a + 1 >= argc)
+			Usage(argv[0]);
+		else if (option == "--tightness")
+			options.tightness = stod(argv[++a]);
+		else if (option == "--max-goods")
+			options.max_goods = stoul(argv[++a]);
+		else if (option == "--fixed-cost")
+			options.fixed_cost = stoul(argv[++a]);
+		else if (option == "--fixed-cost-spread")
+			options.fixed_cost_spread = stod(argv[++a]);
+		else if (option == "--costs" && (string(argv[a + 1]) == "euclidean" || string(argv[a + 1]) == "random"))
+			options.euclidean = string(argv[++a]) == "euclidean";
+		else if (option == "--max-supply-cost")
+			options.max_supply_cost = stoul(argv[++a]);
+		else if (option == "--incompatibility-density")
+			options.incompatibility_density = stod(argv[++a]);
+		else
+		{
+			cerr << "Unknown option " << option << endl;
+			Usage(argv[0]);
+		}
+	}
+
+	WL_Instance* in = GenerateInstance(options);
+	if (!in)
+	{
+		cerr << "Invalid generator options" << endl;
+		exit(1);
+	}
+	ofstream out(argv[1]);
+	in->Write(out);
+	delete in;
+	out.close();
+	if (!out)
+	{
+		cerr << "Cannot write instance file " << argv[1] << endl;
+		exit(1);
+	}
+
+	return 0;
+}
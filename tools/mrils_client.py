@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+# Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+"""Command-line client of the solver daemon (mrils --serve <socket_file>), one request per connection.
+
+Usage:
+    mrils_client.py <socket_file> LOAD <name> <dzn_file>
+    mrils_client.py <socket_file> INSTANCE <name> <dzn_file>          (uploads the file contents)
+    mrils_client.py <socket_file> DELTA <name> <timeout> <changes_file>  (one change per line, see WL_Server.h)
+    mrils_client.py <socket_file> SOLVE <name> <timeout>
+    mrils_client.py <socket_file> DROP <name>
+    mrils_client.py <socket_file> SHUTDOWN
+
+The reply of the server is written to the standard output; the exit status is 1 if it is an error.
+"""
+
+import socket
+import sys
+
+
+def request(socket_file, data):
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as connection:
+        connection.connect(socket_file)
+        connection.sendall(data)
+        connection.shutdown(socket.SHUT_WR)
+        reply = b""
+        while True:
+            chunk = connection.recv(65536)
+            if not chunk:
+                return reply.decode()
+            reply += chunk
+
+
+def main(argv):
+    if len(argv) < 3:
+        sys.exit(__doc__)
+    socket_file, command, args = argv[1], argv[2], argv[3:]
+
+    if command == "INSTANCE" and len(args) == 2:
+        with open(args[1], "rb") as f:
+            contents = f.read()
+        data = b"INSTANCE %s %d\n" % (args[0].encode(), len(contents)) + contents
+    elif command == "DELTA" and len(args) == 3:
+        with open(args[2]) as f:
+            changes = [line.strip() for line in f if line.strip()]
+        data = ("DELTA %s %d %s\n" % (args[0], len(changes), args[1]) + "".join(c + "\n" for c in changes)).encode()
+    else:
+        data = (" ".join([command] + args) + "\n").encode()
+
+    reply = request(socket_file, data)
+    sys.stdout.write(reply)
+    return 1 if not reply.startswith("OK") else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
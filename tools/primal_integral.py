@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+# Copyright (C) 2022  Marcelo R. H. Maia <mmaia@ic.uff.br, marcelo.h.maia@ibge.gov.br>
+
+"""Primal integral of mrils runs, from their convergence traces (mrils ... --trace <file>).
+
+Usage:
+    primal_integral.py [--horizon <seconds>] [--reference <cost>] <trace_file> ...
+
+The primal gap of a run at time t is 1 before its first solution and
+|c(t) - c*| / max(|c(t)|, |c*|) afterwards, where c(t) is the best cost found
+up to t and c* is the reference cost (by default, the best cost over all the
+given traces). The primal integral is the integral of the gap over
+[0, horizon] (by default, the time of the last record over all traces);
+smaller is better, and it rewards converging early as well as converging well.
+Only the "best" records are used (the "ils" records of --trace-ils are ignored).
+"""
+
+import argparse
+import csv
+import sys
+
+
+def read_trace(file_name):
+    improvements = []
+    with open(file_name, newline="") as f:
+        for record in csv.DictReader(f):
+            if record["source"] == "best":
+                improvements.append((float(record["time"]), float(record["cost"])))
+    return improvements
+
+
+def gap(cost, reference):
+    if cost == reference:
+        return 0.0
+    return abs(cost - reference) / max(abs(cost), abs(reference))
+
+
+def primal_integral(improvements, reference, horizon):
+    integral, time, current_gap = 0.0, 0.0, 1.0
+    for t, cost in improvements:
+        if t > horizon:
+            break
+        integral += current_gap * (t - time)
+        time, current_gap = t, gap(cost, reference)
+    return integral + current_gap * (horizon - time)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--horizon", type=float, help="end of the integration interval, in seconds")
+    parser.add_argument("--reference", type=float, help="reference (optimal or best known) cost")
+    parser.add_argument("traces", nargs="+")
+    args = parser.parse_args()
+
+    runs = {file_name: read_trace(file_name) for file_name in args.traces}
+    found = [cost for improvements in runs.values() for _, cost in improvements]
+    if not found:
+        sys.exit("No improvements in the traces")
+
+    reference = args.reference if args.reference is not None else min(found)
+    horizon = args.horizon if args.horizon is not None else max(t for improvements in runs.values() for t, _ in improvements)
+
+    print("trace,final_cost,final_gap,primal_integral")
+    integrals = []
+    for file_name, improvements in runs.items():
+        integral = primal_integral(improvements, reference, horizon)
+        integrals.append(integral)
+        final = [cost for t, cost in improvements if t <= horizon]
+        final_cost = final[-1] if final else float("nan")
+        print("%s,%.2f,%.6f,%.6f" % (file_name, final_cost, gap(final_cost, reference) if final else 1.0, integral))
+    print("# reference cost %.2f, horizon %.3f s, mean primal integral %.6f" % (reference, horizon, sum(integrals) / len(integrals)))
+
+
+if __name__ == "__main__":
+    main()